@@ -0,0 +1,235 @@
+// BatchingTranslator + GoogleTranslator against a local stand-in for the
+// v2 endpoint. The stand-in speaks just enough HTTP/1.1 (keep-alive,
+// Content-Length bodies) to answer form-encoded translate POSTs with
+// "<target>:<text>", after a fixed delay that plays the part of the RTT.
+// It counts POSTs and segments, so the test can check that:
+//   - concurrent callers each get their own segment back
+//   - a burst shares requests (fewer POSTs than segments)
+//   - a lone segment on an idle batcher doesn't wait out maxDelayMs
+//   - a failed request hands the input back untranslated
+//
+//   GoogleBatchingTest
+#include <atomic>
+#include <chrono>
+#include <cstdio>
+#include <memory>
+#include <thread>
+#include <vector>
+#include <juce_core/juce_core.h>
+#include "../Source/translate/BatchingTranslator.h"
+#include "../Source/translate/GoogleTranslator.h"
+#include "../Source/net/HttpClient.h"
+
+namespace
+{
+class StandInServer
+{
+public:
+    explicit StandInServer(int responseDelayMs) : delayMs(responseDelayMs)
+    {
+        if (! listener.createListener(0, "127.0.0.1"))
+            return;
+        acceptThread = std::thread([this] { acceptLoop(); });
+    }
+
+    ~StandInServer()
+    {
+        stopping = true;
+        listener.close();
+        if (acceptThread.joinable())
+            acceptThread.join();
+        for (auto& s : sockets)
+            s->close(); // the client pools its connections; don't wait for it to hang up
+        for (auto& t : connections)
+            t.join();
+    }
+
+    bool isListening() const { return listener.isConnected(); }
+    juce::String url() const { return "http://127.0.0.1:" + juce::String(listener.getBoundPort()) + "/language/translate/v2"; }
+
+    std::atomic<int> posts { 0 }, segments { 0 };
+
+private:
+    void acceptLoop()
+    {
+        while (! stopping)
+        {
+            std::shared_ptr<juce::StreamingSocket> socket(listener.waitForNextConnection());
+            if (socket == nullptr)
+                break;
+            sockets.push_back(socket);
+            connections.emplace_back([this, socket] { serve(*socket); });
+        }
+    }
+
+    // one connection, any number of keep-alive requests
+    void serve(juce::StreamingSocket& socket)
+    {
+        std::string buffer;
+        for (;;)
+        {
+            size_t headerEnd;
+            while ((headerEnd = buffer.find("\r\n\r\n")) == std::string::npos)
+                if (! readMore(socket, buffer))
+                    return;
+
+            const juce::String head(buffer.substr(0, headerEnd));
+            size_t length = 0;
+            for (const auto& line : juce::StringArray::fromLines(head))
+                if (line.startsWithIgnoreCase("content-length:"))
+                    length = (size_t) line.fromFirstOccurrenceOf(":", false, false).trim().getLargeIntValue();
+
+            while (buffer.size() < headerEnd + 4 + length)
+                if (! readMore(socket, buffer))
+                    return;
+
+            const std::string body = buffer.substr(headerEnd + 4, length);
+            buffer.erase(0, headerEnd + 4 + length);
+
+            juce::String json;
+            const bool translated = head.startsWith("HEAD") || translate(body, json);
+            respond(socket, translated ? 200 : 500, json);
+        }
+    }
+
+    static bool readMore(juce::StreamingSocket& socket, std::string& buffer)
+    {
+        char chunk[4096];
+        const int n = socket.read(chunk, (int) sizeof(chunk), false);
+        if (n <= 0)
+            return false;
+        buffer.append(chunk, (size_t) n);
+        return true;
+    }
+
+    // form body: key, q (repeated), source, target, format; false = answer 500
+    bool translate(const std::string& body, juce::String& json)
+    {
+        ++posts;
+        juce::String target;
+        juce::StringArray texts;
+        for (const auto& pair : juce::StringArray::fromTokens(juce::String(body), "&", {}))
+        {
+            const auto name = pair.upToFirstOccurrenceOf("=", false, false);
+            const auto value = juce::URL::removeEscapeChars(pair.fromFirstOccurrenceOf("=", false, false));
+            if (name == "q")
+                texts.add(value);
+            else if (name == "target")
+                target = value;
+        }
+        segments += texts.size();
+
+        if (texts.contains("fail"))
+            return false;
+
+        juce::Array<juce::var> translations;
+        for (const auto& t : texts)
+        {
+            auto* entry = new juce::DynamicObject();
+            entry->setProperty("translatedText", target + ":" + t);
+            translations.add(juce::var(entry));
+        }
+        auto* data = new juce::DynamicObject();
+        data->setProperty("translations", translations);
+        auto* root = new juce::DynamicObject();
+        root->setProperty("data", juce::var(data));
+        json = juce::JSON::toString(juce::var(root), true);
+        return true;
+    }
+
+    void respond(juce::StreamingSocket& socket, int status, const juce::String& json)
+    {
+        std::this_thread::sleep_for(std::chrono::milliseconds(delayMs));
+        const auto body = json.toStdString();
+        juce::String head;
+        head << "HTTP/1.1 " << status << (status == 200 ? " OK" : " Internal Server Error") << "\r\n"
+             << "Content-Type: application/json; charset=UTF-8\r\n"
+             << "Content-Length: " << (int) body.size() << "\r\n"
+             << "Connection: keep-alive\r\n\r\n";
+        const auto bytes = head.toStdString() + body;
+        socket.write(bytes.data(), (int) bytes.size());
+    }
+
+    const int delayMs;
+    juce::StreamingSocket listener;
+    std::atomic<bool> stopping { false };
+    std::thread acceptThread;
+    std::vector<std::shared_ptr<juce::StreamingSocket>> sockets; // accept thread only, until it's joined
+    std::vector<std::thread> connections;
+};
+
+double nowMs()
+{
+    return std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now().time_since_epoch()).count();
+}
+
+bool check(bool ok, const char* what)
+{
+    std::printf("%-52s %s\n", what, ok ? "ok" : "FAILED");
+    return ok;
+}
+} // namespace
+
+int main()
+{
+    StandInServer server(30);
+    if (! server.isListening())
+    {
+        std::fprintf(stderr, "can't listen on 127.0.0.1\n");
+        return 1;
+    }
+
+    const HttpClient::Lifetime http;
+    GoogleTranslator google("stand-in-key");
+    google.setEndpoint(server.url());
+    bool ok = true;
+
+    {
+        BatchingTranslator::Config config;
+        config.maxDelayMs = 200; // long enough that waiting it out would show
+        BatchingTranslator batcher(google, config);
+
+        // a lone segment on an idle batcher goes straight out
+        const double t0 = nowMs();
+        const auto lone = batcher.translate({ "hello", "en", "de" });
+        const double loneMs = nowMs() - t0;
+        ok &= check(lone == "de:hello", "lone segment translated");
+        ok &= check(loneMs < config.maxDelayMs, "lone segment skips the gather delay");
+        std::printf("    %.1f ms\n", loneMs);
+
+        // a burst from concurrent callers shares requests
+        const int callers = 24;
+        const int postsBefore = server.posts.load();
+        std::vector<std::string> results((size_t) callers);
+        std::vector<std::thread> threads;
+        for (int i = 0; i < callers; ++i)
+            threads.emplace_back([&, i] {
+                results[(size_t) i] = batcher.translate({ "segment " + std::to_string(i), "en", i % 2 ? "fr" : "de" });
+            });
+        for (auto& t : threads)
+            t.join();
+
+        bool allOwn = true;
+        for (int i = 0; i < callers; ++i)
+            allOwn &= results[(size_t) i] == std::string(i % 2 ? "fr" : "de") + ":segment " + std::to_string(i);
+        const int burstPosts = server.posts.load() - postsBefore;
+        ok &= check(allOwn, "every caller got its own segment back");
+        ok &= check(burstPosts < callers, "burst used fewer POSTs than segments");
+        std::printf("    %d segments in %d POSTs, %llu batches\n", callers, burstPosts,
+                    (unsigned long long) batcher.getRequestsSent());
+
+        // one ASR segment fanned out to several targets
+        const auto fan = batcher.translateBatch({ { "good morning", "en", "de" },
+                                                  { "good morning", "en", "fr" },
+                                                  { "good morning", "en", "it" } });
+        ok &= check(fan.size() == 3 && fan[0] == "de:good morning" && fan[1] == "fr:good morning"
+                        && fan[2] == "it:good morning", "one segment, three targets");
+
+        // a failed POST comes back untranslated, the rest of the batch unaffected
+        const auto failed = batcher.translateBatch({ { "fail", "en", "de" }, { "fine", "en", "fr" } });
+        ok &= check(failed.size() == 2 && failed[0] == "fail" && failed[1] == "fr:fine", "failed request hands the input back");
+    }
+
+    std::printf("%d POSTs, %d segments\n", server.posts.load(), server.segments.load());
+    return ok ? 0 : 1;
+}
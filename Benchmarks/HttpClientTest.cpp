@@ -0,0 +1,228 @@
+// HttpClient against a local stand-in server that counts the TCP
+// connections it accepts. The stand-in answers any request with a fixed
+// body after a short delay; a request for /short declares more
+// Content-Length than it sends and hangs up. Checks that:
+//   - back-to-back requests share one pooled keep-alive connection
+//   - prewarm() opens the connection the first real request then uses
+//   - a streamed body arrives in full through onData
+//   - a body cut short of its Content-Length is reported as a failure
+//   - a request after the server dropped the connection still succeeds
+//
+//   HttpClientTest
+#include <atomic>
+#include <chrono>
+#include <cstdio>
+#include <memory>
+#include <string>
+#include <thread>
+#include <vector>
+#include <juce_core/juce_core.h>
+#include "../Source/net/HttpClient.h"
+
+namespace
+{
+class StandInServer
+{
+public:
+    StandInServer()
+    {
+        if (! listener.createListener(0, "127.0.0.1"))
+            return;
+        acceptThread = std::thread([this] { acceptLoop(); });
+    }
+
+    ~StandInServer()
+    {
+        stopping = true;
+        listener.close();
+        if (acceptThread.joinable())
+            acceptThread.join();
+        dropConnections();
+        for (auto& t : connections)
+            t.join();
+    }
+
+    bool isListening() const { return listener.isConnected(); }
+    juce::String url(const char* path) const { return "http://127.0.0.1:" + juce::String(listener.getBoundPort()) + path; }
+
+    // hang up on every open connection, as an idle timeout on the server would
+    void dropConnections()
+    {
+        const std::lock_guard<std::mutex> lg(socketsLock);
+        for (auto& s : sockets)
+            s->close();
+    }
+
+    static constexpr size_t bodySize = 100000;
+
+    std::atomic<int> accepted { 0 }, requests { 0 };
+
+private:
+    void acceptLoop()
+    {
+        while (! stopping)
+        {
+            std::shared_ptr<juce::StreamingSocket> socket(listener.waitForNextConnection());
+            if (socket == nullptr)
+                break;
+            ++accepted;
+            {
+                const std::lock_guard<std::mutex> lg(socketsLock);
+                sockets.push_back(socket);
+            }
+            connections.emplace_back([this, socket] { serve(*socket); });
+        }
+    }
+
+    // one connection, any number of keep-alive requests
+    void serve(juce::StreamingSocket& socket)
+    {
+        std::string buffer;
+        for (;;)
+        {
+            size_t headerEnd;
+            while ((headerEnd = buffer.find("\r\n\r\n")) == std::string::npos)
+                if (! readMore(socket, buffer))
+                    return;
+
+            const juce::String head(buffer.substr(0, headerEnd));
+            size_t length = 0;
+            for (const auto& line : juce::StringArray::fromLines(head))
+                if (line.startsWithIgnoreCase("content-length:"))
+                    length = (size_t) line.fromFirstOccurrenceOf(":", false, false).trim().getLargeIntValue();
+
+            while (buffer.size() < headerEnd + 4 + length)
+                if (! readMore(socket, buffer))
+                    return;
+            buffer.erase(0, headerEnd + 4 + length);
+            ++requests;
+
+            std::this_thread::sleep_for(std::chrono::milliseconds(5));
+            const bool isHead = head.startsWith("HEAD");
+            const bool cutShort = head.upToFirstOccurrenceOf("\r\n", false, false).contains("/short");
+
+            const std::string body(cutShort ? bodySize / 10 : bodySize, 'x');
+            juce::String reply;
+            reply << "HTTP/1.1 200 OK\r\n"
+                  << "Content-Type: application/octet-stream\r\n"
+                  << "Content-Length: " << (int) bodySize << "\r\n"
+                  << "Connection: keep-alive\r\n\r\n";
+            auto bytes = reply.toStdString();
+            if (! isHead)
+                bytes += body;
+            socket.write(bytes.data(), (int) bytes.size());
+
+            if (cutShort)
+            {
+                socket.close();
+                return;
+            }
+        }
+    }
+
+    static bool readMore(juce::StreamingSocket& socket, std::string& buffer)
+    {
+        char chunk[4096];
+        const int n = socket.read(chunk, (int) sizeof(chunk), false);
+        if (n <= 0)
+            return false;
+        buffer.append(chunk, (size_t) n);
+        return true;
+    }
+
+    juce::StreamingSocket listener;
+    std::atomic<bool> stopping { false };
+    std::thread acceptThread;
+    std::mutex socketsLock;
+    std::vector<std::shared_ptr<juce::StreamingSocket>> sockets;
+    std::vector<std::thread> connections; // accept thread only, until it's joined
+};
+
+HttpRequest post(const juce::String& url)
+{
+    HttpRequest r;
+    r.url = url;
+    r.timeoutMs = 5000;
+    r.headers.set("Content-Type", "text/plain");
+    r.body.append("hello", 5);
+    return r;
+}
+
+bool check(bool ok, const char* what)
+{
+    std::printf("%-56s %s\n", what, ok ? "ok" : "FAILED");
+    return ok;
+}
+} // namespace
+
+int main()
+{
+    StandInServer server;
+    if (! server.isListening())
+    {
+        std::fprintf(stderr, "can't listen on 127.0.0.1\n");
+        return 1;
+    }
+
+    const HttpClient::Lifetime http;
+    auto& client = HttpClient::shared();
+    bool ok = true;
+
+    // prewarm: the connection is open before the first real request
+    client.prewarm(server.url("/prewarm"));
+    for (int i = 0; i < 200 && client.getStats().requests == 0; ++i)
+        std::this_thread::sleep_for(std::chrono::milliseconds(5));
+    ok &= check(server.accepted.load() == 1, "prewarm opened a connection");
+
+    // back-to-back requests on the pooled connection
+    bool allOk = true, allReused = true;
+    double firstMs = 0.0, laterMs = 0.0;
+    for (int i = 0; i < 10; ++i)
+    {
+        const auto response = client.send(post(server.url("/echo")));
+        allOk &= response.ok() && response.body.getSize() == StandInServer::bodySize;
+        allReused &= response.timings.reusedConnection;
+        (i == 0 ? firstMs : laterMs) += response.timings.totalMs;
+    }
+    ok &= check(allOk, "ten requests answered in full");
+    ok &= check(allReused && server.accepted.load() == 1, "all of them reused the prewarmed connection");
+    std::printf("    %d connections for %d requests, first %.1f ms, then %.1f ms mean\n",
+                server.accepted.load(), server.requests.load(), firstMs, laterMs / 9.0);
+
+    // streamed body
+    size_t streamed = 0;
+    int pieces = 0;
+    const auto streamedResponse = client.send(post(server.url("/stream")), [&](const void*, size_t size) {
+        streamed += size;
+        ++pieces;
+        return true;
+    });
+    ok &= check(streamedResponse.ok() && streamed == StandInServer::bodySize && streamedResponse.body.getSize() == 0,
+                "streamed body arrives in full through onData");
+    std::printf("    %zu bytes in %d pieces\n", streamed, pieces);
+
+    // cut short of Content-Length: a failure, not a 200
+    const auto cut = client.send(post(server.url("/short")));
+    ok &= check(! cut.ok() && cut.status == 0 && cut.error.isNotEmpty(), "body cut short is reported as a failure");
+    std::printf("    status %d, \"%s\"\n", cut.status, cut.error.toRawUTF8());
+
+    size_t streamedShort = 0;
+    const auto cutStreamed = client.send(post(server.url("/short")), [&](const void*, size_t size) {
+        streamedShort += size;
+        return true;
+    });
+    ok &= check(! cutStreamed.ok() && streamedShort < StandInServer::bodySize, "... and when streamed");
+
+    // the server drops its idle connections; the next request reconnects
+    server.dropConnections();
+    const int before = server.accepted.load();
+    const auto after = client.send(post(server.url("/echo")));
+    ok &= check(after.ok() && after.body.getSize() == StandInServer::bodySize && server.accepted.load() == before + 1,
+                "request after the server hung up reconnects");
+
+    const auto stats = client.getStats();
+    std::printf("%llu requests, %llu new connections, %llu failures; server saw %d connections\n",
+                (unsigned long long) stats.requests, (unsigned long long) stats.newConnections,
+                (unsigned long long) stats.failures, server.accepted.load());
+    return ok ? 0 : 1;
+}
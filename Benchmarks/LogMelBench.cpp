@@ -0,0 +1,198 @@
+// Per-decode cost of whisper's log-mel front end with and without
+// LogMelCache, for 2, 5 and 10 s decode windows re-decoded every 0.5 s hop.
+//
+//   pcm path    whisper_pcm_to_mel: every decode runs the STFT over the whole
+//               window plus the 30 s of zero padding whisper.cpp appends
+//   mel cache   the frames for the new hop only, then gather() of the window
+//               in whisper_set_mel's layout
+//
+// The front-end numbers need no model: they time LogMelCache's own STFT,
+// which is the same algorithm whisper.cpp uses. Built against whisper
+// (LT_BENCH_WHISPER) and given a model, it also times whisper's own
+// pcm_to_mel against set_mel and a full decode down each path.
+//
+//   LogMelBench [ggml-model.bin [threads]]
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <cstdio>
+#include <cstdlib>
+#include <memory>
+#include <vector>
+#include "../Source/dsp/LogMelCache.h"
+#include "../Source/dsp/SlidingWindow.h"
+
+#if LT_BENCH_WHISPER
+ #include "whisper.h"
+#endif
+
+namespace
+{
+constexpr int sampleRate = 16000;
+constexpr int numMels = 80;
+constexpr size_t hopSamples = sampleRate / 2;
+constexpr size_t padSamples = (size_t) sampleRate * 30;
+
+double nowMs()
+{
+    return std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now().time_since_epoch()).count();
+}
+
+// Speech-band tones plus a little noise; the front end's cost doesn't depend
+// on the content
+std::vector<float> testSignal(size_t n)
+{
+    std::vector<float> x(n);
+    uint32_t seed = 1;
+    for (size_t i = 0; i < n; ++i)
+    {
+        seed = seed * 1664525u + 1013904223u;
+        const double t = (double) i / sampleRate;
+        x[i] = (float) (0.3 * std::sin(2.0 * 3.14159265 * 220.0 * t) + 0.2 * std::sin(2.0 * 3.14159265 * 1700.0 * t)
+                        + 0.05 * ((double) (seed >> 8) / 16777216.0 - 0.5));
+    }
+    return x;
+}
+
+void append(SlidingWindow& history, const float* x, size_t n)
+{
+    for (size_t done = 0; done < n;)
+    {
+        const size_t take = std::min<size_t>(n - done, 4096);
+        std::copy(x + done, x + done + take, history.writePointer());
+        history.commit(take);
+        done += take;
+    }
+}
+
+struct FrontEnd
+{
+    double pcmPathMs = 0.0, cachedMs = 0.0;
+};
+
+FrontEnd measureFrontEnd(const std::vector<float>& audio, size_t windowSamples, int decodes)
+{
+    FrontEnd r;
+
+    // pcm path: a fresh STFT over window + padding on every decode
+    {
+        SlidingWindow history(windowSamples + padSamples + 2 * LogMelCache::fftSize);
+        LogMelCache mel(numMels, (windowSamples + padSamples) / LogMelCache::hop + 4);
+        const std::vector<float> zeros(padSamples, 0.0f);
+
+        const double t0 = nowMs();
+        for (int d = 0; d < decodes; ++d)
+        {
+            history.clear();
+            mel.reset();
+            append(history, audio.data() + (size_t) d * hopSamples, windowSamples);
+            append(history, zeros.data(), zeros.size());
+            mel.update(history, windowSamples + padSamples);
+        }
+        r.pcmPathMs = (nowMs() - t0) / decodes;
+    }
+
+    // cache: the stream keeps flowing; each decode adds one hop and gathers
+    {
+        SlidingWindow history(windowSamples + 2 * LogMelCache::fftSize);
+        LogMelCache mel(numMels, windowSamples / LogMelCache::hop + 4);
+        uint64_t seen = 0;
+
+        append(history, audio.data(), windowSamples);
+        seen = windowSamples;
+        mel.update(history, seen);
+
+        const double t0 = nowMs();
+        for (int d = 0; d < decodes; ++d)
+        {
+            append(history, audio.data() + seen, hopSamples);
+            seen += hopSamples;
+            mel.update(history, seen);
+            volatile float sink = mel.gather(seen - windowSamples, windowSamples)[0];
+            (void) sink;
+        }
+        r.cachedMs = (nowMs() - t0) / decodes;
+    }
+    return r;
+}
+} // namespace
+
+int main(int argc, char** argv)
+{
+    const int decodes = 20;
+    const size_t windows[] = { 2, 5, 10 };
+    const auto audio = testSignal((size_t) (10 + decodes) * sampleRate);
+
+    std::printf("front end per decode (%d decodes, 0.5 s hop)\n", decodes);
+    std::printf("%8s %14s %14s %10s\n", "window", "pcm path ms", "mel cache ms", "saving");
+    for (size_t w : windows)
+    {
+        const auto r = measureFrontEnd(audio, w * sampleRate, decodes);
+        std::printf("%7zus %14.2f %14.2f %9.1fx\n", w, r.pcmPathMs, r.cachedMs, r.pcmPathMs / std::max(r.cachedMs, 1e-6));
+    }
+
+#if LT_BENCH_WHISPER
+    if (argc < 2)
+        return 0;
+
+    const int threads = argc > 2 ? std::max(1, std::atoi(argv[2])) : 4;
+    whisper_context* ctx = whisper_init_from_file_with_params(argv[1], whisper_context_default_params());
+    if (ctx == nullptr)
+    {
+        std::fprintf(stderr, "can't load %s\n", argv[1]);
+        return 1;
+    }
+    whisper_state* state = whisper_init_state(ctx);
+    const int mels = whisper_model_n_mels(ctx);
+
+    whisper_full_params params = whisper_full_default_params(WHISPER_SAMPLING_GREEDY);
+    params.print_progress = false;
+    params.print_realtime = false;
+    params.print_timestamps = false;
+    params.no_context = true;
+    params.single_segment = true;
+    params.language = "en";
+    params.n_threads = threads;
+
+    std::printf("\nwhisper, %s, %d threads (mean of 3)\n", argv[1], threads);
+    std::printf("%8s %14s %14s %16s %16s\n", "window", "pcm_to_mel ms", "set_mel ms", "decode pcm ms", "decode mel ms");
+    for (size_t w : windows)
+    {
+        const size_t n = w * sampleRate;
+        SlidingWindow history(n + 2 * LogMelCache::fftSize);
+        LogMelCache mel(mels, n / LogMelCache::hop + 4);
+        append(history, audio.data(), n);
+        mel.update(history, n);
+
+        double toMel = 0.0, setMel = 0.0, fullPcm = 0.0, fullMel = 0.0;
+        for (int rep = 0; rep < 3; ++rep)
+        {
+            double t0 = nowMs();
+            whisper_pcm_to_mel_with_state(ctx, state, audio.data(), (int) n, threads);
+            toMel += nowMs() - t0;
+
+            t0 = nowMs();
+            whisper_set_mel_with_state(ctx, state, mel.gather(0, n), LogMelCache::maxFrames, mels);
+            setMel += nowMs() - t0;
+
+            t0 = nowMs();
+            whisper_full_with_state(ctx, state, params, audio.data(), (int) n);
+            fullPcm += nowMs() - t0;
+
+            // the engine's path: features already in the state, no PCM
+            t0 = nowMs();
+            whisper_set_mel_with_state(ctx, state, mel.gather(0, n), LogMelCache::maxFrames, mels);
+            whisper_full_with_state(ctx, state, params, nullptr, 0);
+            fullMel += nowMs() - t0;
+        }
+        std::printf("%7zus %14.2f %14.2f %16.1f %16.1f\n", w, toMel / 3, setMel / 3, fullPcm / 3, fullMel / 3);
+    }
+
+    whisper_free_state(state);
+    whisper_free(ctx);
+#else
+    (void) argc;
+    (void) argv;
+#endif
+    return 0;
+}
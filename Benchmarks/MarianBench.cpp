@@ -0,0 +1,220 @@
+// On-device translation (LocalTranslator + MarianModel) against the Google
+// v2 client: per-sentence latency and batched throughput for the same
+// sentences, plus an end-to-end check of a converted opus-mt model.
+//
+//   MarianBench <dir>/opus-mt-<src>-<dst>.gguf [--check refs.tsv] [--google KEY] [--threads N]
+//
+// --check takes the "source<TAB>reference" file convert-opus-mt.py writes with
+// --reference (transformers' own greedy output). The sentences come from it,
+// and the run fails unless at least 80% of the local translations match the
+// reference exactly (quantised weights can flip the odd token). Without it a
+// built-in list of English sentences is used. The Google half runs when a
+// key is given (or GOOGLE_TRANSLATE_KEY is set).
+#include <algorithm>
+#include <cstdio>
+#include <cstdlib>
+#include <memory>
+#include <string>
+#include <vector>
+#include <juce_core/juce_core.h>
+#include "../Source/engine/InferenceScheduler.h"
+#include "../Source/net/HttpClient.h"
+#include "../Source/translate/GoogleTranslator.h"
+#include "../Source/translate/LocalTranslator.h"
+#include "../Source/translate/PassThroughTranslator.h"
+
+namespace
+{
+const char* const builtIn[] = {
+    "Good morning, everyone.",
+    "Please take your seats, we are about to begin.",
+    "Thank you all for coming today.",
+    "The next speaker will talk about climate change.",
+    "Can everybody hear me at the back?",
+    "We will take a short break at eleven o'clock.",
+    "Lunch will be served in the main hall.",
+    "Do you have any questions so far?",
+    "This project started three years ago with a small team.",
+    "Our results show a clear improvement over last year.",
+    "I would like to thank our sponsors for their support.",
+    "The slides will be available on our website after the talk.",
+    "Let me explain how the system works in practice.",
+    "If you need translation, please use the headphones on your desk.",
+    "The meeting will end at five in the afternoon.",
+    "See you all tomorrow morning."
+};
+
+struct Timing
+{
+    double p50 = 0.0, p95 = 0.0, mean = 0.0;
+};
+
+Timing summarise(std::vector<double> ms)
+{
+    Timing t;
+    if (ms.empty())
+        return t;
+    std::sort(ms.begin(), ms.end());
+    t.p50 = ms[ms.size() / 2];
+    t.p95 = ms[std::min(ms.size() - 1, (size_t) ((double) ms.size() * 0.95))];
+    for (double x : ms) t.mean += x;
+    t.mean /= (double) ms.size();
+    return t;
+}
+
+double nowMs() { return juce::Time::getMillisecondCounterHiRes(); }
+
+std::vector<TranslateRequest> requestsFor(const std::vector<std::string>& sentences, const std::string& src, const std::string& dst)
+{
+    std::vector<TranslateRequest> out;
+    for (const auto& s : sentences)
+        out.push_back({ s, src, dst, 10000 });
+    return out;
+}
+
+// latency: one sentence per call; throughput: batches of 1 / 4 / 8
+bool bench(const char* name, ITranslator& t, const std::vector<TranslateRequest>& requests, int reps)
+{
+    bool allOk = true;
+    std::vector<double> single;
+    t.tryTranslate(requests.front()); // warm-up: model mapping / connection
+    for (int rep = 0; rep < reps; ++rep)
+        for (const auto& r : requests)
+        {
+            const double t0 = nowMs();
+            allOk &= t.tryTranslate(r).ok;
+            single.push_back(nowMs() - t0);
+        }
+
+    const auto lat = summarise(single);
+    std::printf("%-8s latency   p50 %8.1f ms   p95 %8.1f ms   mean %8.1f ms\n", name, lat.p50, lat.p95, lat.mean);
+
+    for (size_t batch : { (size_t) 1, (size_t) 4, (size_t) 8 })
+    {
+        size_t done = 0;
+        const double t0 = nowMs();
+        for (int rep = 0; rep < reps; ++rep)
+            for (size_t start = 0; start < requests.size(); start += batch)
+            {
+                const std::vector<TranslateRequest> chunk(requests.begin() + (std::ptrdiff_t) start,
+                                                          requests.begin() + (std::ptrdiff_t) std::min(requests.size(), start + batch));
+                for (const auto& r : t.tryTranslateBatch(chunk))
+                    allOk &= r.ok;
+                done += chunk.size();
+            }
+        const double sec = (nowMs() - t0) / 1000.0;
+        std::printf("%-8s batch %zu  %8.1f sentences/s\n", name, batch, (double) done / sec);
+    }
+    if (! allOk)
+        std::printf("%-8s some requests failed\n", name);
+    return allOk;
+}
+} // namespace
+
+int main(int argc, char** argv)
+{
+    if (argc < 2)
+    {
+        std::fprintf(stderr, "usage: MarianBench <dir>/opus-mt-<src>-<dst>.gguf [--check refs.tsv] [--google KEY] [--threads N]\n");
+        return 2;
+    }
+
+    const juce::File model(juce::File::getCurrentWorkingDirectory().getChildFile(argv[1]));
+    juce::String refsPath, googleKey(juce::SystemStats::getEnvironmentVariable("GOOGLE_TRANSLATE_KEY", {}));
+    int threads = 0;
+    for (int i = 2; i + 1 < argc; i += 2)
+    {
+        const juce::String opt(argv[i]);
+        if (opt == "--check")        refsPath = argv[i + 1];
+        else if (opt == "--google")  googleKey = argv[i + 1];
+        else if (opt == "--threads") threads = std::atoi(argv[i + 1]);
+    }
+
+    // opus-mt-<src>-<dst>.gguf
+    const auto pair = juce::StringArray::fromTokens(model.getFileNameWithoutExtension().fromFirstOccurrenceOf("opus-mt-", false, false), "-", {});
+    if (pair.size() != 2 || ! model.existsAsFile())
+    {
+        std::fprintf(stderr, "%s is not an opus-mt-<src>-<dst>.gguf file\n", argv[1]);
+        return 2;
+    }
+    const std::string src = pair[0].toStdString(), dst = pair[1].toStdString();
+
+    std::vector<std::string> sentences, references;
+    if (refsPath.isNotEmpty())
+    {
+        juce::StringArray lines;
+        lines.addLines(juce::File::getCurrentWorkingDirectory().getChildFile(refsPath).loadFileAsString());
+        for (const auto& line : lines)
+            if (line.contains("\t"))
+            {
+                sentences.push_back(line.upToFirstOccurrenceOf("\t", false, false).toStdString());
+                references.push_back(line.fromFirstOccurrenceOf("\t", false, false).toStdString());
+            }
+    }
+    else
+    {
+        sentences.assign(std::begin(builtIn), std::end(builtIn));
+    }
+    if (sentences.empty())
+    {
+        std::fprintf(stderr, "no sentences\n");
+        return 2;
+    }
+
+    if (threads > 0)
+    {
+        InferenceScheduler::Config sc;
+        sc.workers = 1;
+        sc.threadsPerJob = threads;
+        InferenceScheduler::instance().configure(sc);
+    }
+
+    const HttpClient::Lifetime http;
+    PassThroughTranslator none;
+    bool ok = true;
+
+    {
+        LocalTranslator local(none, model.getParentDirectory());
+        const double t0 = nowMs();
+        local.preload(src, dst);
+        std::printf("%s-%s, %zu sentences, load %.0f ms, %d threads per decode\n", src.c_str(), dst.c_str(), sentences.size(),
+                    nowMs() - t0, InferenceScheduler::instance().getThreadsPerJob());
+
+        const auto requests = requestsFor(sentences, src, dst);
+
+        // end-to-end: the converted model against transformers' greedy output
+        if (! references.empty())
+        {
+            const auto results = local.tryTranslateBatch(requests);
+            size_t exact = 0;
+            for (size_t i = 0; i < results.size(); ++i)
+            {
+                const bool same = results[i].ok && results[i].text == references[i];
+                exact += same ? 1 : 0;
+                if (! same)
+                    std::printf("  differs: %s\n     ours: %s\n      ref: %s\n", sentences[i].c_str(), results[i].text.c_str(), references[i].c_str());
+            }
+            const bool passed = exact * 5 >= results.size() * 4;
+            std::printf("check     %zu / %zu match the reference exactly: %s\n", exact, results.size(), passed ? "ok" : "FAILED");
+            ok &= passed;
+        }
+
+        ok &= bench("local", local, requests, 3);
+        const auto s = local.getStats();
+        std::printf("local     %llu sentences in %llu batches, %llu fell back\n", (unsigned long long) s.sentences,
+                    (unsigned long long) s.batches, (unsigned long long) s.fallbacks);
+
+        if (googleKey.isNotEmpty())
+        {
+            GoogleTranslator google(googleKey);
+            google.prewarm();
+            ok &= bench("google", google, requests, 3);
+        }
+        else
+        {
+            std::printf("google    skipped (no --google key / GOOGLE_TRANSLATE_KEY)\n");
+        }
+    }
+
+    return ok ? 0 : 1;
+}
@@ -0,0 +1,165 @@
+// Producer/consumer throughput of RingBuffer<T, Channels> against the
+// LockFreeRingBuffer it replaced. One thread pushes a counting sequence in
+// host-sized blocks, another pops it and checks every sample arrived in
+// order; both spin (no wakeups), so the numbers are the ring's own cost.
+//
+//   RingBufferBench [seconds-of-audio-per-case]
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <thread>
+#include <vector>
+#include "../Source/dsp/RingBuffer.h"
+
+namespace
+{
+// The pre-template ring, kept verbatim (runtime channels, % wrap, both
+// indices on one cache line) as the baseline
+class LegacyRing
+{
+public:
+    LegacyRing(size_t capacityFrames, int numChannels)
+        : channels(numChannels), capacity(capacityFrames), writeIndex(0), readIndex(0)
+    {
+        buffer.resize(capacity * channels);
+    }
+
+    size_t push(const float* interleaved, size_t frames)
+    {
+        size_t written = 0;
+        while (written < frames)
+        {
+            size_t w = writeIndex.load(std::memory_order_relaxed);
+            size_t r = readIndex.load(std::memory_order_acquire);
+            size_t freeFrames = capacity - (w - r);
+            if (freeFrames == 0) break;
+
+            size_t chunk = std::min(frames - written, freeFrames);
+            size_t wPos = w % capacity;
+            size_t firstPart = std::min(chunk, capacity - wPos);
+            std::memcpy(&buffer[wPos * channels], &interleaved[written * channels], firstPart * channels * sizeof(float));
+            if (chunk > firstPart)
+                std::memcpy(&buffer[0], &interleaved[(written + firstPart) * channels], (chunk - firstPart) * channels * sizeof(float));
+
+            writeIndex.store(w + chunk, std::memory_order_release);
+            written += chunk;
+        }
+        return written;
+    }
+
+    size_t pop(float* interleaved, size_t frames)
+    {
+        size_t read = 0;
+        while (read < frames)
+        {
+            size_t r = readIndex.load(std::memory_order_relaxed);
+            size_t w = writeIndex.load(std::memory_order_acquire);
+            size_t available = w - r;
+            if (available == 0) break;
+
+            size_t chunk = std::min(frames - read, available);
+            size_t rPos = r % capacity;
+            size_t firstPart = std::min(chunk, capacity - rPos);
+            std::memcpy(&interleaved[read * channels], &buffer[rPos * channels], firstPart * channels * sizeof(float));
+            if (chunk > firstPart)
+                std::memcpy(&interleaved[(read + firstPart) * channels], &buffer[0], (chunk - firstPart) * channels * sizeof(float));
+
+            readIndex.store(r + chunk, std::memory_order_release);
+            read += chunk;
+        }
+        return read;
+    }
+
+private:
+    int channels;
+    size_t capacity;
+    std::vector<float> buffer;
+    std::atomic<size_t> writeIndex, readIndex;
+};
+
+struct Result
+{
+    double framesPerSec = 0.0;
+    bool inOrder = true;
+};
+
+// Sample value for frame f, channel c: exact in float and in int16
+template <typename T>
+T valueAt(size_t frame, int channel) { return (T) (int16_t) ((frame * 7 + (size_t) channel) & 0x7fff); }
+
+template <typename T, typename Ring>
+Result run(Ring& ring, int channels, size_t block, size_t totalFrames)
+{
+    std::atomic<bool> go { false };
+    Result result;
+
+    std::thread consumer([&] {
+        std::vector<T> in(block * (size_t) channels);
+        while (! go.load()) {}
+        for (size_t got = 0; got < totalFrames;)
+        {
+            const size_t n = ring.pop(in.data(), std::min(block, totalFrames - got));
+            for (size_t f = 0; f < n && result.inOrder; ++f)
+                for (int c = 0; c < channels; ++c)
+                    if (in[f * (size_t) channels + (size_t) c] != valueAt<T>(got + f, c))
+                        result.inOrder = false;
+            got += n;
+        }
+    });
+
+    std::vector<T> out(block * (size_t) channels);
+    go.store(true);
+    const auto t0 = std::chrono::steady_clock::now();
+    for (size_t sent = 0; sent < totalFrames;)
+    {
+        const size_t n = std::min(block, totalFrames - sent);
+        for (size_t f = 0; f < n; ++f)
+            for (int c = 0; c < channels; ++c)
+                out[f * (size_t) channels + (size_t) c] = valueAt<T>(sent + f, c);
+
+        for (size_t done = 0; done < n;)
+            done += ring.push(out.data() + done * (size_t) channels, n - done);
+        sent += n;
+    }
+    consumer.join();
+    const double sec = std::chrono::duration<double>(std::chrono::steady_clock::now() - t0).count();
+
+    result.framesPerSec = (double) totalFrames / sec;
+    return result;
+}
+} // namespace
+
+int main(int argc, char** argv)
+{
+    const double audioSec = argc > 1 ? std::max(1.0, std::atof(argv[1])) : 600.0;
+    const size_t capacity = 48000 * 10;
+    bool ok = true;
+
+    std::printf("%-28s %6s %14s %14s %8s\n", "ring", "block", "Mframes/s", "x realtime", "order");
+    const auto report = [&](const char* name, size_t block, double rate, const Result& r) {
+        std::printf("%-28s %6zu %14.1f %14.0f %8s\n", name, block, r.framesPerSec / 1e6, r.framesPerSec / rate, r.inOrder ? "ok" : "BROKEN");
+        ok = ok && r.inOrder;
+    };
+
+    for (size_t block : { 32, 128, 512, 2048 })
+    {
+        const size_t stereoFrames = (size_t) (audioSec * 48000.0);
+        {
+            LegacyRing ring(capacity, 2);
+            report("LockFreeRingBuffer (2ch)", block, 48000.0, run<float>(ring, 2, block, stereoFrames));
+        }
+        {
+            StereoFifo ring(capacity);
+            report("RingBuffer<float, 2>", block, 48000.0, run<float>(ring, 2, block, stereoFrames));
+        }
+        {
+            // the ASR history: 16 kHz mono int16, fed a third of the frames
+            AsrRing16k ring(16000 * 20);
+            report("RingBuffer<int16_t, 1>", block / 3 + 1, 16000.0, run<int16_t>(ring, 1, block / 3 + 1, (size_t) (audioSec * 16000.0)));
+        }
+    }
+
+    return ok ? 0 : 1;
+}
@@ -204,6 +204,12 @@ void LiveTranslatorAudioProcessorEditor::resized()
 
 void LiveTranslatorAudioProcessorEditor::timerCallback()
 {
+    // Model load / warm-up progress until the engine is ready
+    const bool modelReady = proc.isModelReady();
+    if (! modelReady || ! modelWasReady)
+        status.setText(proc.getModelStatus(), dontSendNotification);
+    modelWasReady = modelReady;
+
     //transcript.setText(proc.getLastTranscript(), false);
     // Transcript polling (safe, lightweight)
     static String lastShown;
@@ -216,6 +222,49 @@ void LiveTranslatorAudioProcessorEditor::timerCallback()
         status.setText("Transcribing…", dontSendNotification);
     }
 
+    // Translation cache counters, whenever they move
+    const auto cacheSummary = proc.getTranslationCacheSummary();
+    if (cacheSummary != lastCacheSummary)
+    {
+        proc.appendDebug(cacheSummary);
+        lastCacheSummary = cacheSummary;
+    }
+
+    const auto routeSummary = proc.getRouteSummary();
+    if (routeSummary != lastRouteSummary)
+    {
+        proc.appendDebug(routeSummary);
+        lastRouteSummary = routeSummary;
+    }
+
+    const auto realtimeSummary = proc.getRealtimeSummary();
+    if (realtimeSummary != lastRealtimeSummary)
+    {
+        proc.appendDebug(realtimeSummary);
+        lastRealtimeSummary = realtimeSummary;
+    }
+
+    const auto languageSummary = proc.getLanguageSummary();
+    if (languageSummary != lastLanguageSummary)
+    {
+        proc.appendDebug(languageSummary);
+        lastLanguageSummary = languageSummary;
+    }
+
+    const auto outputSummary = proc.getOutputStageSummary();
+    if (outputSummary != lastOutputStageSummary)
+    {
+        proc.appendDebug(outputSummary);
+        lastOutputStageSummary = outputSummary;
+    }
+
+    const auto speechSummary = proc.getSpeechCacheSummary();
+    if (speechSummary != lastSpeechCacheSummary)
+    {
+        proc.appendDebug(speechSummary);
+        lastSpeechCacheSummary = speechSummary;
+    }
+
     // Debug drain
     const auto dbg = proc.pullDebugSinceLast();
     if (dbg.isNotEmpty())
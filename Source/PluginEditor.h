@@ -27,6 +27,13 @@ private:
     //juce::ToggleButton silenceIfSame { "Silence if same language" };
     juce::ToggleButton showDebug{ "Show debug panel" };
     juce::TextEditor debug;
+    bool modelWasReady = false;
+    juce::String lastCacheSummary;
+    juce::String lastRouteSummary;
+    juce::String lastOutputStageSummary;
+    juce::String lastLanguageSummary;
+    juce::String lastRealtimeSummary;
+    juce::String lastSpeechCacheSummary;
 
     juce::Label googleKeyLabel { {}, "Google API Key:" };
     juce::TextEditor googleKeyField;
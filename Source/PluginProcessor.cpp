@@ -1,6 +1,5 @@
 #include "PluginProcessor.h"
 #include "PluginEditor.h"
-#include "engine/Pipeline.h"
 #include "tts/AzureTTs.h"
 
 LiveTranslatorAudioProcessor::LiveTranslatorAudioProcessor()
@@ -13,6 +12,11 @@ LiveTranslatorAudioProcessor::LiveTranslatorAudioProcessor()
     apvts.state.setProperty("googleKey", "", nullptr);
     apvts.state.setProperty("azureKey", "", nullptr);
     apvts.state.setProperty("azureRegion", "eastus", nullptr);
+    apvts.state.setProperty("inferenceWorkers", 0, nullptr);        // 0 = from the core budget
+    apvts.state.setProperty("inferenceThreadsPerJob", 0, nullptr);  // 0 = budget / workers
+    apvts.state.setProperty("inferenceReservedCores", 1, nullptr);
+    apvts.state.setProperty("inferencePinning", false, nullptr);
+    applyInferenceSettings();
 
     translator.setKey(apvts.state.getProperty("googleKey", "").toString());
     azureKey = apvts.state.getProperty("azureKey", "").toString();
@@ -22,38 +26,55 @@ LiveTranslatorAudioProcessor::LiveTranslatorAudioProcessor()
     tts.setRegion(azureRegion);
 
     WhisperParams p;
-    p.modelPath = "Source/external/whisper.cpp/models/ggml-base.en.bin";
+    p.modelPath = "Source/external/whisper.cpp/models/ggml-base.en.bin"; // fallback
+    p.modelDir  = "Source/external/whisper.cpp/models"; // auto-select from here
+    p.targetRtf = 0.5f;
     p.dstLang = "en";
 
-    whisper = std::make_unique<WhisperEngine>(input16k, bus, translator, tts, p);
-    whisper->start();
+    // TTS chunks are resampled into outFifo on the thread that produced them
+    bus.setTtsSink([this](const TtsPcmMsg& m) { playTts(m); });
+
+    // the engine loads (or shares) the model on its own thread, so
+    // construction and host plugin scans don't wait on disk. It starts once
+    // the session is restored (or at the first prepareToPlay), so a saved
+    // model pick can stand in for the first-run benchmark.
+    whisper = std::make_unique<WhisperEngine>(input16k, bus, cachedTranslator, cachedTts, p);
+    whisper->setLogCallback([this](const juce::String& line) { appendDebug(line); });
+    localTranslator.setLogCallback([this](const juce::String& line) { appendDebug(line); });
+    whisper->setCallback([this](const juce::String& text, const juce::String&) {
+        appendDebug("ASR: " + text);
+        {
+            const juce::ScopedLock sl(textMx);
+            lastTranscript = text;
+        }
+        if (transcriptLog != nullptr)
+            transcriptLog->logMessage("ASR: " + text);
+    });
+    whisper->setOnTranslated([this](const std::string& src, const std::string& dst) {
+        appendDebug("Translate: " + juce::String::fromUTF8(src.c_str()) + " -> " + juce::String::fromUTF8(dst.c_str()));
+    });
+    updateVoice();
 }
 
 
 LiveTranslatorAudioProcessor::~LiveTranslatorAudioProcessor() {
     if (whisper) whisper->stop();
+    bus.setTtsSink(nullptr);
 };
 
-void LiveTranslatorAudioProcessor::prepareToPlay (double sr, int)
+void LiveTranslatorAudioProcessor::prepareToPlay (double sr, int maxBlock)
 {
-    resampler.reset();
-    
-    sampleRateHz = sr;
+    {
+        const std::lock_guard<std::mutex> lock(playbackLock);
+        resampler.reset();
+    }
+    ingest.prepare(sr, maxBlock);
 
-    pipeline = std::make_unique<Pipeline>(inFifo, outFifo, *whisper, *this);
-    pipeline->setLanguages("auto", "en");
-    if (juce::File::getSpecialLocation(juce::File::userDocumentsDirectory).getChildFile("Source/external/whisper.cpp/models/ggml-base.en.bin").existsAsFile())
-        // pipeline->start(juce::File::getSpecialLocation(juce::File::userDocumentsDirectory).getChildFile("models/ggml-base.en.bin"));
-        pipeline->start(juce::File("Source/external/whisper.cpp/models/ggml-base.en.bin"));
-    else
-        appendDebug("Model file not set.\n");
-    
+    startEngine();
 }
 
 void LiveTranslatorAudioProcessor::releaseResources()
 {
-    if (pipeline) pipeline->stop();
-    pipeline.reset();
 }
 
 bool LiveTranslatorAudioProcessor::isBusesLayoutSupported (const BusesLayout& layouts) const
@@ -66,61 +87,80 @@ void LiveTranslatorAudioProcessor::processBlock (juce::AudioBuffer<float>& buffe
 {
     juce::ScopedNoDenormals noDenormals;
 
-    // 1) enqueue input for ASR
-    pipeline->pushAudioFromDSP(buffer.getReadPointer(0), buffer.getNumSamples(),
-                               buffer.getNumChannels(), sampleRateHz);
+    const int numCh = buffer.getNumChannels();
+    const int N = buffer.getNumSamples();
 
-    // 2) mix any pending TTS audio onto output
-    static std::vector<float> tmp(4800*2);
-    const int frames = buffer.getNumSamples();
-    if ((int)tmp.size() < frames * buffer.getNumChannels())
-        tmp.resize(frames * buffer.getNumChannels());
+    // 1) enqueue input for ASR (before any TTS is mixed in, so we don't
+    //    transcribe ourselves): downmix + decimate + int16 ring in one pass
+    ingest.process(buffer, input16k, whisper->getParams().parkWakeLevel);
 
-    size_t got = outFifo.pop(tmp.data(), (size_t) frames);
-    if (got > 0)
+    // 2) mix any pending TTS audio onto output, straight out of the fifo
+    //    (already at host SR; playTts() fills it off the audio thread)
     {
-        for (int ch=0; ch<buffer.getNumChannels(); ++ch)
+        constexpr int fifoCh = StereoFifo::numChannels;
+        auto region = outFifo.peekRead((size_t) N);
+        auto mixSpan = [&](const float* src, size_t frames, int offset)
         {
-            auto* dst = buffer.getWritePointer(ch);
-            for (size_t i=0; i<got; ++i)
-                dst[i] += tmp[i*buffer.getNumChannels() + ch]; // mix under
-        }
+            for (int ch=0; ch<numCh; ++ch)
+            {
+                auto* dst = buffer.getWritePointer(ch) + offset;
+                const int srcCh = std::min(ch, fifoCh - 1);
+                for (size_t i=0; i<frames; ++i)
+                    dst[i] += src[i*fifoCh + srcCh]; // mix under
+            }
+        };
+        mixSpan(region.data1, region.frames1, 0);
+        mixSpan(region.data2, region.frames2, (int) region.frames1);
+        outFifo.consumeRead(region.frames());
     }
-    const int numCh = buffer.getNumChannels();
-    const int N = buffer.getNumSamples();
+}
+
+// Off the audio thread: one 16 kHz TTS chunk -> host SR -> both channels of
+// outFifo, after whatever is already queued. A full fifo holds the TTS stage
+// back until processBlock drains it; with no host pulling audio the rest of
+// the chunk is dropped after a couple of seconds. playbackLock is only held
+// while resampling or writing, never while waiting, so prepareToPlay isn't
+// stuck behind a full fifo.
+void LiveTranslatorAudioProcessor::playTts(const TtsPcmMsg& m)
+{
     const double hostSR = getSampleRate();
+    if (m.pcm16k.empty() || hostSR <= 0.0)
+        return;
 
-    // 1) downmix to mono (scratch)
-    scratch.setSize(1, N, false, false, true);
-    auto* mono = scratch.getWritePointer(0);
-    if (numCh == 1) {
-        std::memcpy(mono, buffer.getReadPointer(0), sizeof(float)*N);
-    } else {
-        for (int i = 0; i < N; ++i) {
-            double s = 0.0;
-            for (int c = 0; c < numCh; ++c) s += buffer.getReadPointer(c)[i];
-            mono[i] = (float)(s / (double)numCh);
-        }
+    {
+        const std::lock_guard<std::mutex> lock(playbackLock);
+        resampler.processFrom16k(m.pcm16k.data(), (int) m.pcm16k.size(), hostSR, ttsOutMono);
     }
 
-    // 2) resample to 16k and push to ring
-    resampler.processTo16k(mono, N, hostSR, mono16k);
-    if (!mono16k.empty())
-        input16k.push(mono16k.data(), mono16k.size());
-
-    // 3) Pull any TTS chunks and mix to output
-    //    (convert back to host SR & stereo)
-    TtsPcmMsg msg;
-    std::vector<float> outMono;
-    while (bus.popTts(msg)) {
-        resampler.processFrom16k(msg.pcm16k.data(), (int)msg.pcm16k.size(), hostSR, ttsOutMono);
-        // mix to all channels softly
-        for (int c = 0; c < numCh; ++c) {
-            auto* ch = buffer.getWritePointer(c);
-            for (size_t i = 0; i < std::min<size_t>(ttsOutMono.size(), (size_t)N); ++i) {
-                ch[i] += ttsOutMono[i]; // simple add; later use gain/env
-            }
+    constexpr int fifoCh = StereoFifo::numChannels;
+    auto writeSpan = [](float* dst, const float* src, size_t frames)
+    {
+        for (size_t i=0; i<frames; ++i)
+            for (int ch=0; ch<fifoCh; ++ch)
+                dst[i*fifoCh + ch] = src[i];
+    };
+
+    const float* src = ttsOutMono.data();
+    size_t left = ttsOutMono.size();
+    for (int waitedMs = 0; left > 0 && waitedMs < 2000; )
+    {
+        size_t written = 0;
+        {
+            const std::lock_guard<std::mutex> lock(playbackLock);
+            auto region = outFifo.prepareWrite(left);
+            writeSpan(region.data1, src, region.frames1);
+            writeSpan(region.data2, src + region.frames1, region.frames2);
+            outFifo.commitWrite(region.frames());
+            written = region.frames();
         }
+        if (written == 0)
+        {
+            juce::Thread::sleep(5);
+            waitedMs += 5;
+            continue;
+        }
+        src += written;
+        left -= written;
     }
 }
 
@@ -136,6 +176,16 @@ void LiveTranslatorAudioProcessor::getStateInformation (juce::MemoryBlock& destD
     apvts.state.setProperty("voiceStyle", voiceStyle, nullptr);
     apvts.state.setProperty("autoDetect", autoDetect.load(), nullptr);
 
+    // ASR model picked for this machine (informational; see setStateInformation).
+    // Before the engine has picked one, the restored pick is kept as it was.
+    const auto asr = whisper->getSelection();
+    if (asr.isValid())
+    {
+        apvts.state.setProperty("asrModel", juce::String(asr.modelPath), nullptr);
+        apvts.state.setProperty("asrThreads", asr.threads, nullptr);
+        apvts.state.setProperty("asrRtf", asr.rtf, nullptr);
+    }
+
     juce::MemoryOutputStream mos(destData, false);
     apvts.state.writeToStream(mos);
 }
@@ -159,19 +209,100 @@ void LiveTranslatorAudioProcessor::setStateInformation (const void* data, int si
     voiceGender = apvts.state.getProperty("voiceGender", "Female").toString();
     voiceStyle  = apvts.state.getProperty("voiceStyle", "Conversational").toString();
     autoDetect.store( (bool) apvts.state.getProperty("autoDetect", true) );
+    applyInferenceSettings();
+
+    // A session from an uncalibrated machine seeds the calibration cache with
+    // the saved pick instead of benchmarking; a machine's own calibration wins.
+    const auto& wp = whisper->getParams();
+    const auto cwd = juce::File::getCurrentWorkingDirectory();
+    const auto savedModel = apvts.state.getProperty("asrModel", "").toString();
+    const auto modelDir = cwd.getChildFile(juce::String(wp.modelDir));
+    if (! wp.modelDir.empty() && savedModel.isNotEmpty() && cwd.getChildFile(savedModel).existsAsFile()
+        && ! ModelCalibrator::cached(modelDir, wp.targetRtf).isValid())
+    {
+        ModelCalibrator::Result r;
+        r.modelPath = cwd.getChildFile(savedModel).getFullPathName().toStdString();
+        r.threads   = (int) apvts.state.getProperty("asrThreads", 0);
+        r.rtf       = (double) apvts.state.getProperty("asrRtf", 0.0);
+        ModelCalibrator::store(modelDir, wp.targetRtf, r);
+
+        // the host started playback before restoring the session: abandon the
+        // benchmark under way, the restart reads the seeded pick back
+        if (whisper->getModelState() == WhisperEngine::ModelState::calibrating)
+            whisper->stop();
+    }
+
+    setLanguages(inLang, outLang);
+    startEngine();
+}
+
+void LiveTranslatorAudioProcessor::startEngine()
+{
+    if (whisper == nullptr || whisper->isRunning())
+        return;
 
-    if (pipeline) pipeline->setLanguages(inLang, outLang);
+    // written from the engine's worker, so it exists before the worker does
+    if (transcriptLog == nullptr)
+        transcriptLog = std::make_unique<juce::FileLogger>(juce::File::getSpecialLocation(juce::File::userDocumentsDirectory)
+                                                               .getChildFile("LiveTranslator.log"), "LiveTranslator");
+    whisper->start();
+}
+
+void LiveTranslatorAudioProcessor::applyInferenceSettings()
+{
+    // One scheduler serves every instance, so the last one to apply its settings wins;
+    // an unchanged config is a no-op and doesn't restart the workers.
+    InferenceScheduler::Config c;
+    c.workers             = (int) apvts.state.getProperty("inferenceWorkers", 0);
+    c.threadsPerJob       = (int) apvts.state.getProperty("inferenceThreadsPerJob", 0);
+    c.reservedCores       = (int) apvts.state.getProperty("inferenceReservedCores", 1);
+    c.pinAwayFromReserved = (bool) apvts.state.getProperty("inferencePinning", false);
+    InferenceScheduler::instance().configure(c);
 }
 
 void LiveTranslatorAudioProcessor::setLanguages(const juce::String& in, const juce::String& out)
 {
-    if (pipeline) pipeline->setLanguages(in, out);
+    inLang = in;
+    outLang = out;
+
+    if (whisper)
+    {
+        whisper->setLanguage(autoDetect.load() ? juce::String("auto") : in);
+        whisper->setTargetLanguage(out);
+    }
+    updateVoice();
+
+    localTranslator.preload(RoutePlanner::languageCode(in), RoutePlanner::languageCode(out));
+
+    // the first translated utterance shouldn't pay for DNS + TCP + TLS
+    translator.prewarm();
+    tts.prewarm();
 }
 
 void LiveTranslatorAudioProcessor::setAutoDetect(bool enabled)
 {
     autoDetect.store(enabled);
-    if (pipeline) pipeline->setAutoDetect(enabled); // add stub in Pipeline (no-op ok)
+    if (whisper) whisper->setLanguage(enabled ? juce::String("auto") : inLang);
+}
+
+void LiveTranslatorAudioProcessor::setVoiceGender(const juce::String& g)
+{
+    voiceGender = g;
+    updateVoice();
+}
+
+void LiveTranslatorAudioProcessor::setVoiceStyle(const juce::String& s)
+{
+    voiceStyle = s;
+    updateVoice();
+}
+
+void LiveTranslatorAudioProcessor::updateVoice()
+{
+    // the voice is part of the speech cache key, so it's resolved here
+    // rather than left to the backend's default
+    const auto v = tts.pickVoice(juce::String(RoutePlanner::languageCode(outLang)), voiceGender, voiceStyle);
+    if (whisper) whisper->setVoice(v.name.toStdString(), v.style.toStdString());
 }
 
 juce::String LiveTranslatorAudioProcessor::getLastTranscript() const
@@ -198,6 +329,114 @@ juce::String LiveTranslatorAudioProcessor::pullDebugSinceLast()
     return out;
 }
 
+bool LiveTranslatorAudioProcessor::isModelReady() const
+{
+    return whisper != nullptr && whisper->getModelState() == WhisperEngine::ModelState::ready;
+}
+
+juce::String LiveTranslatorAudioProcessor::getModelStatus() const
+{
+    if (whisper == nullptr)
+        return "Model not loaded";
+
+    switch (whisper->getModelState())
+    {
+        case WhisperEngine::ModelState::notLoaded: return "Model not loaded";
+        case WhisperEngine::ModelState::calibrating: return "Benchmarking models...";
+        case WhisperEngine::ModelState::loading:
+            return "Loading model... " + juce::String(juce::roundToInt(whisper->getLoadProgress() * 100.0f)) + "%";
+        case WhisperEngine::ModelState::warmingUp: return "Warming up model...";
+        case WhisperEngine::ModelState::ready:     return "Listening...";
+        case WhisperEngine::ModelState::failed:    return "Model failed to load";
+    }
+    return {};
+}
+
+juce::String LiveTranslatorAudioProcessor::getTranslationCacheSummary() const
+{
+    const auto s = cachedTranslator.getStats();
+    if (s.hits + s.misses + s.coalesced == 0)
+        return {};
+
+    return "Translation cache: " + juce::String((juce::int64) s.hits) + " hits ("
+         + juce::String((juce::int64) s.diskHits) + " from disk), "
+         + juce::String((juce::int64) s.misses) + " misses, "
+         + juce::String((juce::int64) s.coalesced) + " coalesced";
+}
+
+juce::String LiveTranslatorAudioProcessor::getRouteSummary() const
+{
+    if (whisper == nullptr)
+        return {};
+
+    const auto s = whisper->getRouteStats();
+    if (s.utterances[0] + s.utterances[1] + s.utterances[2] == 0)
+        return {};
+
+    return "Routes: " + juce::String((juce::int64) s.utterances[(size_t) Route::machineTranslate]) + " translated, "
+         + juce::String((juce::int64) s.utterances[(size_t) Route::whisperTranslate]) + " by whisper, "
+         + juce::String((juce::int64) s.utterances[(size_t) Route::passThrough]) + " same language ("
+         + juce::String((juce::int64) s.charsNotTranslated) + " chars kept off MT)";
+}
+
+juce::String LiveTranslatorAudioProcessor::getRealtimeSummary() const
+{
+    if (whisper == nullptr)
+        return {};
+
+    const auto s = whisper->getRealtimeStats();
+    if (s.level == 0 && s.dropEvents == 0)
+        return {};
+
+    return "ASR real time: level " + juce::String(s.level) + ", "
+         + juce::String(s.droppedSamples / 16000.0, 1) + " s dropped in "
+         + juce::String((int) s.dropEvents) + " drops";
+}
+
+juce::String LiveTranslatorAudioProcessor::getLanguageSummary() const
+{
+    if (whisper == nullptr)
+        return {};
+
+    const auto s = whisper->getLanguageStats();
+    if (s.detections + s.pinnedDecodes == 0)
+        return {};
+
+    return "Language ID: " + juce::String((juce::int64) s.detections) + " detection passes, "
+         + juce::String((juce::int64) s.pinnedDecodes) + " decodes on the pinned language, "
+         + juce::String((juce::int64) s.switches) + " switches";
+}
+
+juce::String LiveTranslatorAudioProcessor::getOutputStageSummary() const
+{
+    if (whisper == nullptr)
+        return {};
+
+    const auto s = whisper->getOutputStats();
+    if (s.translate.processed + s.translate.dropped + s.tts.processed + s.tts.dropped == 0)
+        return {};
+
+    const auto stage = [](const char* name, const StageStats& st) {
+        return juce::String(name) + " " + juce::String((juce::int64) st.processed) + " done, "
+             + juce::String((juce::int64) st.depth) + "/" + juce::String((juce::int64) st.capacity) + " queued, "
+             + juce::String((juce::int64) st.dropped) + " dropped";
+    };
+    return "Output: " + stage("translate", s.translate) + "; " + stage("TTS", s.tts);
+}
+
+juce::String LiveTranslatorAudioProcessor::getSpeechCacheSummary() const
+{
+    const auto s = cachedTts.getStats();
+    if (s.hits + s.misses == 0)
+        return {};
+
+    return "Speech cache: " + juce::String((juce::int64) s.hits) + " hits ("
+         + juce::String((juce::int64) s.diskHits) + " from disk), "
+         + juce::String((juce::int64) s.misses) + " misses, "
+         + juce::String((juce::int64) (s.memoryBytes / 1024)) + " KB in memory, "
+         + juce::String((juce::int64) (s.diskBytes / 1024)) + " KB on disk";
+}
+
 juce::AudioProcessorValueTreeState::ParameterLayout
 LiveTranslatorAudioProcessor::createParameterLayout()
 {
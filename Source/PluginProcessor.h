@@ -1,17 +1,23 @@
 #pragma once
-class Pipeline;
 #include <juce_audio_processors/juce_audio_processors.h>
-#include "dsp/LockFreeRingBuffer.h"
+#include "dsp/RingBuffer.h"
 #include "engine/WhisperEngine.h"
-#include "engine/Pipeline.h"
 #include "engine/MessageBus.h"
 #include "tts/BeepTts.h"
 #include "translate/PassThroughTranslator.h"
 #include "dsp/Resample16k.h"
+#include "dsp/AsrIngest.h"
 #include <atomic>
 #include <mutex>
 #include "translate/GoogleTranslator.h"
+#include "translate/BatchingTranslator.h"
+#include "translate/LocalTranslator.h"
+#include "translate/CachingTranslator.h"
+#include "translate/ResilientTranslator.h"
+#include "tts/CachingTts.h"
+#include "tts/ResilientTts.h"
 #include "tts/AzureTTs.h"
+#include "net/HttpClient.h"
 
 class LiveTranslatorAudioProcessor : public juce::AudioProcessor
 {
@@ -21,8 +27,17 @@ public:
 
     juce::AudioProcessorValueTreeState apvts;
 
+    HttpClient::Lifetime http; // before every backend below, so it outlives them
     GoogleTranslator translator;
+    LocalTranslator localTranslator { translator, LocalTranslator::defaultModelDir() }; // Google for pairs without a model
+    BatchingTranslator batchedTranslator { localTranslator };
+    PassThroughTranslator passThrough;  // answers when translation is late or down
+    ResilientTranslator resilientTranslator { batchedTranslator, passThrough };
+    CachingTranslator cachedTranslator { resilientTranslator, CachingTranslator::defaultStoreFile() };
     AzureTTS tts;
+    BeepTts beepTts;                     // speaks when Azure is late or down
+    ResilientTts resilientTts { tts, beepTts };
+    CachingTts cachedTts { resilientTts, CachingTts::defaultStoreDir() }; // outside: hits skip the breaker / p95
 
     GoogleTranslator& getTranslator() { return translator; }
     AzureTTS& getAzureTTS() { return tts; }
@@ -63,9 +78,17 @@ public:
     juce::String getLastTranscript() const; //safe copy
     void appendDebug(const juce::String& line);
     juce::String pullDebugSinceLast();      // returns & clears incremental buffer
-
-    void setVoiceGender(const juce::String& g) { voiceGender = g; }
-    void setVoiceStyle (const juce::String& s) { voiceStyle = s;  }
+    bool isModelReady() const;
+    juce::String getModelStatus() const;    // load progress / ready state for the UI
+    juce::String getTranslationCacheSummary() const; // hit / miss counters for the debug panel
+    juce::String getRouteSummary() const;            // utterances per route, for the debug panel
+    juce::String getOutputStageSummary() const;      // translate / TTS queue depth and drops, for the debug panel
+    juce::String getRealtimeSummary() const;         // ASR degrade level and dropped audio, for the debug panel
+    juce::String getLanguageSummary() const;         // detection passes vs. pinned decodes, for the debug panel
+    juce::String getSpeechCacheSummary() const;      // TTS cache hits / size, for the debug panel
+
+    void setVoiceGender(const juce::String& g);
+    void setVoiceStyle (const juce::String& s);
     juce::String getVoiceGender() const { return voiceGender; }
     juce::String getVoiceStyle () const { return voiceStyle;  }
 
@@ -87,9 +110,16 @@ private:
 
     std::atomic<bool> autoDetect { true };
 
+    void updateVoice(); // outLang + gender + style -> the engine's TTS voice
+    void startEngine(); // first call loads / selects the ASR model
+    void applyInferenceSettings(); // stored "inference*" settings -> InferenceScheduler (process-wide)
+    void playTts(const TtsPcmMsg& m); // TTS thread: 16k chunk -> outFifo
+
     // Input FIFO -> 16k audio pipeline
-    LockFreeRingBuffer input16k { 16000 * 20, 1 }; // 20s safety
-    Resample16k resampler;
+    AsrRing16k input16k { 16000 * 20 }; // 20s safety (int16, rounded up to 2^n)
+    AsrIngest ingest;                   // host block -> input16k, audio thread
+    Resample16k resampler;              // TTS 16k -> host SR, under playbackLock
+    std::mutex playbackLock;            // resampler + outFifo's write side: playTts() vs. prepareToPlay()
 
     // Messaging
     MessageBus bus;
@@ -99,10 +129,8 @@ private:
     std::unique_ptr<WhisperEngine> whisper;
 
     // Scratch buffers
-    juce::AudioBuffer<float> scratch;
     std::vector<float> monoTmp;
-    std::vector<float> mono16k;
-    std::vector<float> ttsOutMono;
+    std::vector<float> ttsOutMono;      // playTts() only (one at a time, under the bus's TTS lock)
 
     // UI / state
     juce::String inLang  { "auto" };
@@ -115,11 +143,8 @@ private:
     juce::AudioBuffer<float> previewBuffer;
     std::atomic<bool> previewPending { false };
 
-    std::unique_ptr<Pipeline> pipeline;
-
-    LockFreeRingBuffer inFifo  { 48000 * 10, 2 }; // 10s capacity, stereo
-    LockFreeRingBuffer outFifo { 48000 * 10, 2 }; // TTS audio out (stereo)
-    double sampleRateHz = 48000.0;
+    StereoFifo outFifo { 48000 * 10 }; // TTS audio out (stereo)
+    std::unique_ptr<juce::FileLogger> transcriptLog; // ~/Documents/LiveTranslator.log, from the engine's first start
 
     JUCE_DECLARE_NON_COPYABLE_WITH_LEAK_DETECTOR(LiveTranslatorAudioProcessor)
     static juce::AudioProcessorValueTreeState::ParameterLayout createParameterLayout();
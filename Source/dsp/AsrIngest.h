@@ -0,0 +1,113 @@
+#pragma once
+#include <juce_audio_basics/juce_audio_basics.h>
+#include "PolyphaseResampler.h"
+#include "RingBuffer.h"
+
+// Audio-thread ingest for ASR: downmix -> decimate to 16 kHz -> int16 ring.
+// The downmix is written straight into the resampler's filter history and the
+// filter writes its outputs straight into the ring, so each block is touched
+// once. All storage is sized in prepare(); process() never allocates, and the
+// fractional resampler phase carries across blocks of any size.
+class AsrIngest
+{
+public:
+    void prepare(double hostSR, int maxBlockSize)
+    {
+        rate = hostSR;
+        usePolyphase = down.prepare(hostSR, 16000.0);
+
+        // Lagrange fallback for uncommon host rates
+        fallback.reset();
+        fallbackPending = 0.0;
+        fallbackIn.assign((size_t) std::max(1, maxBlockSize), 0.0f);
+        fallbackOut.assign((size_t) std::ceil(maxBlockSize * 16000.0 / hostSR) + 2, 0.0f);
+    }
+
+    void reset()
+    {
+        if (usePolyphase) down.reset();
+        fallback.reset();
+        fallbackPending = 0.0;
+    }
+
+    // parkWakeLevel: while the ring's reader is parked, blocks quieter than
+    // this are dropped without touching the resampler or the ring.
+    void process(const juce::AudioBuffer<float>& buffer, AsrRing16k& ring, float parkWakeLevel)
+    {
+        const int numCh = buffer.getNumChannels();
+        const int N = buffer.getNumSamples();
+        if (numCh <= 0 || N <= 0) return;
+
+        if (ring.isReaderParked())
+        {
+            if (buffer.getMagnitude(0, N) < parkWakeLevel)
+                return;
+            ring.setReaderParked(false);
+        }
+
+        if (usePolyphase)
+            processPolyphase(buffer, ring, numCh, N);
+        else
+            processFallback(buffer, ring, numCh, N);
+    }
+
+private:
+    void processPolyphase(const juce::AudioBuffer<float>& buffer, AsrRing16k& ring, int numCh, int N)
+    {
+        const float gain = 1.0f / (float) numCh;
+
+        for (int start = 0; start < N;)
+        {
+            int room = 0;
+            float* hist = down.inputWritePointer(room);
+            const int n = std::min(N - start, room);
+            if (n <= 0) break;
+
+            // downmix in place into the filter history
+            juce::FloatVectorOperations::copyWithMultiply(hist, buffer.getReadPointer(0, start), gain, n);
+            for (int c = 1; c < numCh; ++c)
+                juce::FloatVectorOperations::addWithMultiply(hist, buffer.getReadPointer(c, start), gain, n);
+            down.commitInput(n);
+            start += n;
+
+            // decimate straight into the ring
+            auto region = ring.prepareWrite((size_t) down.maxOutFor(0));
+            int produced = down.produce(region.data1, (int) region.frames1);
+            if (produced == (int) region.frames1)
+                produced += down.produce(region.data2, (int) region.frames2);
+            ring.commitWrite((size_t) produced);
+        }
+    }
+
+    void processFallback(const juce::AudioBuffer<float>& buffer, AsrRing16k& ring, int numCh, int N)
+    {
+        N = std::min(N, (int) fallbackIn.size());
+        const float gain = 1.0f / (float) numCh;
+
+        float* mono = fallbackIn.data();
+        juce::FloatVectorOperations::copyWithMultiply(mono, buffer.getReadPointer(0), gain, N);
+        for (int c = 1; c < numCh; ++c)
+            juce::FloatVectorOperations::addWithMultiply(mono, buffer.getReadPointer(c), gain, N);
+
+        const double speed = rate / 16000.0;
+        fallbackPending += N;
+        const int numOut = std::min((int) fallbackOut.size(), (int) (fallbackPending / speed));
+        fallbackPending -= numOut * speed;
+        if (numOut <= 0) return;
+
+        fallback.process(speed, mono, fallbackOut.data(), numOut, N, 0);
+
+        auto region = ring.prepareWrite((size_t) numOut);
+        convertSamples(fallbackOut.data(), region.data1, region.frames1);
+        convertSamples(fallbackOut.data() + region.frames1, region.data2, region.frames2);
+        ring.commitWrite(region.frames());
+    }
+
+    double rate = 48000.0;
+    bool usePolyphase = false;
+    PolyphaseResampler down;
+
+    juce::LagrangeInterpolator fallback;
+    double fallbackPending = 0.0;
+    std::vector<float> fallbackIn, fallbackOut;
+};
@@ -0,0 +1,215 @@
+#pragma once
+#include <algorithm>
+#include <cmath>
+#include <cstdint>
+#include <vector>
+#include "SlidingWindow.h"
+
+// Whisper's log-mel front end (400-sample Hann frames every 160 samples,
+// 400-point FFT, Slaney mel filters) computed once per frame as audio arrives
+// and kept in a rolling cache keyed by absolute frame index. Overlapping
+// decodes gather their frames from the cache instead of re-running the STFT.
+//
+// Frame k is centred on absolute 16 kHz sample k * hop, as in whisper.cpp.
+// The cache holds raw log10 energies; the per-decode "max - 8 dB" clamp and
+// scaling depend on the decoded span, so they are applied in gather().
+class LogMelCache
+{
+public:
+    static constexpr int fftSize   = 400;
+    static constexpr int hop       = 160;
+    static constexpr int numBins   = fftSize / 2 + 1;
+    static constexpr int maxFrames = 3000; // 30 s encoder input
+
+    LogMelCache(int numMels, size_t capacityFrames)
+        : mels(numMels), capacity(std::max<size_t>(capacityFrames, 1))
+    {
+        for (int i = 0; i < fftSize; ++i)
+        {
+            const double t = 2.0 * kPi * i / fftSize;
+            hann[(size_t) i]  = (float) (0.5 * (1.0 - std::cos(t))); // periodic
+            cosTab[(size_t) i] = (float) std::cos(t);
+            sinTab[(size_t) i] = (float) std::sin(t);
+        }
+        buildFilters();
+
+        frames.assign(capacity * (size_t) mels, 0.0f);
+        out.assign((size_t) mels * maxFrames, 0.0f);
+        power.assign((size_t) numBins, 0.0f);
+        fftIn.assign((size_t) fftSize * 2, 0.0f);
+        fftOut.assign((size_t) fftSize * 8, 0.0f);
+    }
+
+    int numMels() const { return mels; }
+
+    // Start over at absolute sample atSample (e.g. after a gap in the
+    // stream); samples before it read as zeros, like the start of a stream
+    void reset(uint64_t atSample = 0) { nextFrame = (atSample + hop - 1) / hop; }
+
+    // Computes every new frame whose full 400-sample span has arrived.
+    // samplesSeen is the absolute index one past the history's newest sample;
+    // samples older than the history (start of stream) read as zeros.
+    void update(const SlidingWindow& history, uint64_t samplesSeen)
+    {
+        const uint64_t oldest = samplesSeen - history.size();
+
+        for (;; ++nextFrame)
+        {
+            const int64_t first = (int64_t) nextFrame * hop - fftSize / 2;
+            if (first + fftSize > (int64_t) samplesSeen)
+                break;
+
+            const int64_t skip = std::max<int64_t>(0, (int64_t) oldest - first);
+            const size_t  have = (size_t) std::max<int64_t>(0, fftSize - skip);
+            std::fill(fftIn.begin(), fftIn.begin() + fftSize, 0.0f);
+            if (have > 0)
+            {
+                const float* x = history.latest((size_t) (samplesSeen - (uint64_t) (first + skip)));
+                for (size_t i = 0; i < have; ++i)
+                    fftIn[(size_t) skip + i] = x[i] * hann[(size_t) skip + i];
+            }
+
+            computeFrame(frames.data() + (nextFrame % capacity) * (size_t) mels);
+        }
+    }
+
+    // Frames covering [startSample, startSample + numSamples) in the layout
+    // whisper_set_mel() takes ([mel][maxFrames]), normalised like
+    // whisper.cpp's own front end and padded with silence to maxFrames.
+    // The pointer stays valid until the next gather().
+    const float* gather(uint64_t startSample, size_t numSamples)
+    {
+        const uint64_t oldestFrame = nextFrame > capacity ? nextFrame - capacity : 0;
+        const uint64_t f0 = std::max<uint64_t>(oldestFrame, (startSample + hop / 2) / hop);
+        size_t count = std::min<size_t>(numSamples / hop, maxFrames);
+        count = (size_t) std::min<uint64_t>(count, nextFrame > f0 ? nextFrame - f0 : 0);
+
+        float mmax = logFloor;
+        for (size_t i = 0; i < count; ++i)
+        {
+            const float* f = frame(f0 + i);
+            mmax = std::max(mmax, *std::max_element(f, f + mels));
+        }
+        const float clampTo = std::max(logFloor, mmax - 8.0f);
+        const float silence = (clampTo + 4.0f) / 4.0f;
+
+        for (int m = 0; m < mels; ++m)
+        {
+            float* row = out.data() + (size_t) m * maxFrames;
+            for (size_t i = 0; i < count; ++i)
+                row[i] = (std::max(frame(f0 + i)[m], clampTo) + 4.0f) / 4.0f;
+            std::fill(row + count, row + maxFrames, silence);
+        }
+        return out.data();
+    }
+
+private:
+    static constexpr double kPi = 3.14159265358979323846;
+    static constexpr float logFloor = -10.0f; // log10(1e-10)
+
+    const float* frame(uint64_t index) const { return frames.data() + (index % capacity) * (size_t) mels; }
+
+    void computeFrame(float* dst)
+    {
+        fft(fftIn.data(), fftSize, fftOut.data());
+
+        for (int k = 0; k < numBins; ++k)
+            power[(size_t) k] = fftOut[(size_t) (2 * k)] * fftOut[(size_t) (2 * k)]
+                              + fftOut[(size_t) (2 * k + 1)] * fftOut[(size_t) (2 * k + 1)];
+
+        for (int m = 0; m < mels; ++m)
+        {
+            const float* w = filters.data() + (size_t) m * numBins;
+            double sum = 0.0;
+            for (int k = 0; k < numBins; ++k)
+                sum += (double) w[k] * power[(size_t) k];
+            dst[m] = (float) std::log10(std::max(sum, 1e-10));
+        }
+    }
+
+    // Real-input recursive radix-2 FFT with a DFT at odd sizes (400 -> 25),
+    // the same decomposition whisper.cpp uses. 'in' needs 2N floats of
+    // scratch, 'out' 8N; out receives N interleaved complex bins.
+    void fft(float* in, int N, float* outBins) const
+    {
+        if (N == 1) { outBins[0] = in[0]; outBins[1] = 0.0f; return; }
+
+        const int halfN = N / 2;
+        if (N - halfN * 2 == 1) { dft(in, N, outBins); return; }
+
+        float* part = in + N;
+        float* evenFft = outBins + 2 * N;
+        float* oddFft  = evenFft + N;
+
+        for (int i = 0; i < halfN; ++i) part[i] = in[2 * i];
+        fft(part, halfN, evenFft);
+        for (int i = 0; i < halfN; ++i) part[i] = in[2 * i + 1];
+        fft(part, halfN, oddFft);
+
+        const int step = fftSize / N;
+        for (int k = 0; k < halfN; ++k)
+        {
+            const float re = cosTab[(size_t) (k * step)];
+            const float im = -sinTab[(size_t) (k * step)];
+            const float reOdd = oddFft[2 * k], imOdd = oddFft[2 * k + 1];
+
+            outBins[2 * k]                = evenFft[2 * k]     + re * reOdd - im * imOdd;
+            outBins[2 * k + 1]            = evenFft[2 * k + 1] + re * imOdd + im * reOdd;
+            outBins[2 * (k + halfN)]      = evenFft[2 * k]     - re * reOdd + im * imOdd;
+            outBins[2 * (k + halfN) + 1]  = evenFft[2 * k + 1] - re * imOdd - im * reOdd;
+        }
+    }
+
+    void dft(const float* in, int N, float* outBins) const
+    {
+        const int step = fftSize / N;
+        for (int k = 0; k < N; ++k)
+        {
+            float re = 0.0f, im = 0.0f;
+            for (int n = 0; n < N; ++n)
+            {
+                const int idx = (k * n * step) % fftSize;
+                re += in[n] * cosTab[(size_t) idx];
+                im -= in[n] * sinTab[(size_t) idx];
+            }
+            outBins[2 * k] = re;
+            outBins[2 * k + 1] = im;
+        }
+    }
+
+    // librosa.filters.mel(sr=16000, n_fft=400, n_mels, htk=False, norm="slaney"),
+    // which is what the whisper models were trained with
+    void buildFilters()
+    {
+        const auto hzToMel = [] (double f) { return f < 1000.0 ? f * 3.0 / 200.0 : 15.0 + std::log(f / 1000.0) * 27.0 / std::log(6.4); };
+        const auto melToHz = [] (double m) { return m < 15.0 ? m * 200.0 / 3.0 : 1000.0 * std::exp((m - 15.0) * std::log(6.4) / 27.0); };
+
+        std::vector<double> centres((size_t) mels + 2);
+        const double top = hzToMel(8000.0);
+        for (size_t i = 0; i < centres.size(); ++i)
+            centres[i] = melToHz(top * (double) i / (double) (mels + 1));
+
+        filters.assign((size_t) mels * numBins, 0.0f);
+        for (int m = 0; m < mels; ++m)
+        {
+            const double lo = centres[(size_t) m], mid = centres[(size_t) m + 1], hi = centres[(size_t) m + 2];
+            const double norm = 2.0 / (hi - lo);
+            for (int k = 0; k < numBins; ++k)
+            {
+                const double f = 8000.0 * k / (numBins - 1);
+                const double w = std::min((f - lo) / (mid - lo), (hi - f) / (hi - mid));
+                filters[(size_t) m * numBins + (size_t) k] = (float) (std::max(0.0, w) * norm);
+            }
+        }
+    }
+
+    const int mels;
+    const size_t capacity;
+    uint64_t nextFrame = 0; // absolute index of the next frame to compute
+
+    float hann[fftSize] {}, cosTab[fftSize] {}, sinTab[fftSize] {};
+    std::vector<float> filters;            // [mel][bin]
+    std::vector<float> frames;             // ring of [frame][mel], raw log10
+    std::vector<float> out;                // gather() result, [mel][maxFrames]
+    std::vector<float> power, fftIn, fftOut;
+};
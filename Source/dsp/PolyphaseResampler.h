@@ -0,0 +1,306 @@
+#pragma once
+#include <algorithm>
+#include <cmath>
+#include <cstdint>
+#include <cstring>
+#include <vector>
+
+#if defined (__SSE__) || defined (_M_X64) || (defined (_M_IX86_FP) && _M_IX86_FP >= 1)
+ #include <xmmintrin.h>
+ #define LT_POLYPHASE_SSE 1
+#elif defined (__ARM_NEON) || defined (__ARM_NEON__) || defined (_M_ARM64)
+ #include <arm_neon.h>
+ #define LT_POLYPHASE_NEON 1
+#endif
+
+// Polyphase windowed-sinc (Kaiser) resampler for rational ratios L/M.
+// Filter tables for the host <-> 16 kHz ratios we care about are designed
+// entirely at compile time; see PolyphaseResampler::prepare().
+namespace polyphase
+{
+    // ---- constexpr math (std:: versions aren't constexpr in C++17) ----
+    constexpr double kPi = 3.14159265358979323846;
+
+    constexpr double cSin(double x)
+    {
+        // reduce to [-pi, pi], then Taylor; 17th order keeps error < 1e-9
+        const double twoPi = 2.0 * kPi;
+        x -= twoPi * (double) (long long) (x / twoPi);
+        if (x >  kPi) x -= twoPi;
+        if (x < -kPi) x += twoPi;
+
+        const double x2 = x * x;
+        double term = x, sum = x;
+        for (int k = 1; k <= 8; ++k)
+        {
+            term *= -x2 / (double) ((2 * k) * (2 * k + 1));
+            sum += term;
+        }
+        return sum;
+    }
+
+    constexpr double cSqrt(double x)
+    {
+        if (x <= 0.0) return 0.0;
+        double r = x > 1.0 ? x : 1.0;
+        for (int i = 0; i < 40; ++i)
+        {
+            const double next = 0.5 * (r + x / r);
+            if (next == r) break;
+            r = next;
+        }
+        return r;
+    }
+
+    // zeroth-order modified Bessel function of the first kind
+    constexpr double cBesselI0(double x)
+    {
+        const double q = x * x * 0.25;
+        double term = 1.0, sum = 1.0;
+        for (int k = 1; k < 40; ++k)
+        {
+            term *= q / (double) (k * k);
+            sum += term;
+            if (term < sum * 1e-12) break;
+        }
+        return sum;
+    }
+
+    constexpr double kKaiserBeta = 7.0; // ~70 dB stopband
+
+    // Rows are stored newest-tap-last so each output is a plain dot product
+    // with the input history x[i - Taps + 1 .. i].
+    template <int L, int M, int Taps>
+    struct Table
+    {
+        static_assert(Taps % 8 == 0, "taps must be a multiple of the SIMD width");
+        alignas(16) float coeffs[L][Taps] {};
+    };
+
+    template <int L, int M, int Taps>
+    constexpr Table<L, M, Taps> design()
+    {
+        Table<L, M, Taps> t {};
+
+        // prototype runs at L * inRate; put the cutoff at the lower Nyquist
+        const int    n      = L * Taps;
+        const double centre = 0.5 * (double) (n - 1);
+        const double fc     = 0.5 / (double) (L > M ? L : M);
+        const double i0Beta = cBesselI0(kKaiserBeta);
+
+        for (int p = 0; p < L; ++p)
+        {
+            double rowSum = 0.0;
+            double row[Taps] {};
+
+            for (int j = 0; j < Taps; ++j)
+            {
+                const double x    = (double) (j * L + p) - centre;
+                const double sinc = x == 0.0 ? 2.0 * fc : cSin(2.0 * kPi * fc * x) / (kPi * x);
+                const double r    = x / centre;
+                const double win  = cBesselI0(kKaiserBeta * cSqrt(1.0 - r * r)) / i0Beta;
+                row[j] = sinc * win;
+                rowSum += row[j];
+            }
+
+            // unity DC gain for every phase
+            for (int j = 0; j < Taps; ++j)
+                t.coeffs[p][Taps - 1 - j] = (float) (row[j] / rowSum);
+        }
+        return t;
+    }
+
+    struct TableView
+    {
+        const float* coeffs = nullptr;
+        int L = 1, M = 1, taps = 0;
+
+        const float* row(int phase) const { return coeffs + (size_t) phase * (size_t) taps; }
+    };
+
+    template <int L, int M, int Taps>
+    const TableView& table()
+    {
+        static constexpr Table<L, M, Taps> t = design<L, M, Taps>();
+        static const TableView view { &t.coeffs[0][0], L, M, Taps };
+        return view;
+    }
+
+    // output sample stores (float, or saturated int16 straight into a ring)
+    inline void store(float v, float* dst) { *dst = v; }
+    inline void store(float v, int16_t* dst)
+    {
+        v = std::min(1.0f, std::max(-1.0f, v));
+        *dst = (int16_t) std::lrintf(v * 32767.0f);
+    }
+
+    // taps is a multiple of 8 and a/b are 16-byte aligned only for 'a'
+    inline float dot(const float* a, const float* b, int taps)
+    {
+       #if LT_POLYPHASE_SSE
+        __m128 acc0 = _mm_setzero_ps(), acc1 = _mm_setzero_ps();
+        for (int i = 0; i < taps; i += 8)
+        {
+            acc0 = _mm_add_ps(acc0, _mm_mul_ps(_mm_load_ps(a + i),     _mm_loadu_ps(b + i)));
+            acc1 = _mm_add_ps(acc1, _mm_mul_ps(_mm_load_ps(a + i + 4), _mm_loadu_ps(b + i + 4)));
+        }
+        acc0 = _mm_add_ps(acc0, acc1);
+        acc0 = _mm_add_ps(acc0, _mm_movehl_ps(acc0, acc0));
+        acc0 = _mm_add_ss(acc0, _mm_shuffle_ps(acc0, acc0, 1));
+        return _mm_cvtss_f32(acc0);
+       #elif LT_POLYPHASE_NEON
+        float32x4_t acc0 = vdupq_n_f32(0.0f), acc1 = vdupq_n_f32(0.0f);
+        for (int i = 0; i < taps; i += 8)
+        {
+            acc0 = vmlaq_f32(acc0, vld1q_f32(a + i),     vld1q_f32(b + i));
+            acc1 = vmlaq_f32(acc1, vld1q_f32(a + i + 4), vld1q_f32(b + i + 4));
+        }
+        acc0 = vaddq_f32(acc0, acc1);
+        float32x2_t s = vadd_f32(vget_low_f32(acc0), vget_high_f32(acc0));
+        return vget_lane_f32(vpadd_f32(s, s), 0);
+       #else
+        float s0 = 0.0f, s1 = 0.0f, s2 = 0.0f, s3 = 0.0f;
+        for (int i = 0; i < taps; i += 4)
+        {
+            s0 += a[i] * b[i];         s1 += a[i + 1] * b[i + 1];
+            s2 += a[i + 2] * b[i + 2]; s3 += a[i + 3] * b[i + 3];
+        }
+        return (s0 + s1) + (s2 + s3);
+       #endif
+    }
+}
+
+// Streaming polyphase resampler. Input is buffered in a linear history so
+// callers can write new samples in place (inputWritePointer/commitInput) and
+// the fractional phase carries across blocks of any size.
+class PolyphaseResampler
+{
+public:
+    static constexpr int maxInputChunk = 1024;
+
+    // Picks the compile-time table for inRate -> outRate. Returns false for
+    // ratios we don't have a table for (caller should fall back).
+    bool prepare(double inRate, double outRate)
+    {
+        const auto* t = pickTable((int) (inRate + 0.5), (int) (outRate + 0.5));
+        if (t == nullptr || std::abs(inRate - (double) (int) (inRate + 0.5)) > 1e-6)
+        {
+            tab = {};
+            return false;
+        }
+
+        tab = *t;
+        history.assign((size_t) (tab.taps + maxInputChunk), 0.0f);
+        reset();
+        return true;
+    }
+
+    bool isPrepared() const { return tab.coeffs != nullptr; }
+
+    void reset()
+    {
+        std::fill(history.begin(), history.end(), 0.0f);
+        histLen = tab.taps - 1; // zero-primed
+        pos = tab.taps - 1;
+        phase = 0;
+    }
+
+    // Space for up to 'room' new input samples, to be filled in place
+    float* inputWritePointer(int& room)
+    {
+        compact();
+        room = (int) history.size() - histLen;
+        return history.data() + histLen;
+    }
+
+    void commitInput(int n) { histLen += n; }
+
+    // Emit as many outputs as the buffered input allows (up to maxOut)
+    template <typename OutT>
+    int produce(OutT* out, int maxOut)
+    {
+        int produced = 0;
+        const float* h = history.data();
+
+        while (pos < histLen && produced < maxOut)
+        {
+            polyphase::store(polyphase::dot(tab.row(phase), h + pos - (tab.taps - 1), tab.taps), out + produced++);
+            phase += tab.M;
+            pos += phase / tab.L;
+            phase %= tab.L;
+        }
+        return produced;
+    }
+
+    // Convenience: resample a whole block into out (returns samples written)
+    int process(const float* in, int numIn, float* out, int maxOut)
+    {
+        int produced = 0;
+        while (numIn > 0)
+        {
+            int room = 0;
+            float* dst = inputWritePointer(room);
+            const int n = std::min(numIn, room);
+            if (n == 0) break; // output full and history can't grow: drop the rest
+            std::memcpy(dst, in, sizeof(float) * (size_t) n);
+            commitInput(n);
+            in += n; numIn -= n;
+            produced += produce(out + produced, maxOut - produced);
+        }
+        return produced + produce(out + produced, maxOut - produced);
+    }
+
+    // Upper bound of outputs for numIn more inputs
+    int maxOutFor(int numIn) const
+    {
+        if (! isPrepared()) return 0;
+        return (int) (((long long) (histLen - pos + numIn) * tab.L) / tab.M) + 2;
+    }
+
+private:
+    static const polyphase::TableView* pickTable(int in, int out)
+    {
+        using namespace polyphase;
+        // taps per phase: 32 input samples of support, scaled by the
+        // decimation factor when going down (multiple of 8)
+        if (out == 16000)
+        {
+            switch (in)
+            {
+                case 44100: return &table<160, 441, 88>();
+                case 48000: return &table<1, 3, 96>();
+                case 88200: return &table<80, 441, 176>();
+                case 96000: return &table<1, 6, 192>();
+                default: break;
+            }
+        }
+        else if (in == 16000)
+        {
+            switch (out)
+            {
+                case 44100: return &table<441, 160, 32>();
+                case 48000: return &table<3, 1, 32>();
+                case 88200: return &table<441, 80, 32>();
+                case 96000: return &table<6, 1, 32>();
+                default: break;
+            }
+        }
+        return nullptr;
+    }
+
+    // drop history the filter no longer needs
+    void compact()
+    {
+        const int base = pos - (tab.taps - 1);
+        if (base <= 0) return;
+        std::memmove(history.data(), history.data() + base, sizeof(float) * (size_t) (histLen - base));
+        histLen -= base;
+        pos -= base;
+    }
+
+    polyphase::TableView tab;
+    std::vector<float> history;
+    int histLen = 0;
+    int pos = 0;   // index of the newest input sample the next output needs
+    int phase = 0; // current polyphase branch, 0..L-1
+};
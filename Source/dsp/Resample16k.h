@@ -1,26 +1,98 @@
 #pragma once
 #include <juce_audio_basics/juce_audio_basics.h>
+#include "PolyphaseResampler.h"
 
+// Host SR <-> 16 kHz mono. Uses the compile-time polyphase tables for the
+// common host rates (44.1/48/88.2/96 kHz) and falls back to Lagrange for
+// anything else. State is rebuilt whenever the host rate changes.
 struct Resample16k {
-    juce::LagrangeInterpolator to16k, from16k;
-
-    // hostSR -> 16k mono
-    void processTo16k(const float* inMono, int numIn, double hostSR, std::vector<float>& out16k) {
-        const double ratio = 16000.0 / hostSR;
-        const int expected = (int)std::ceil(numIn * ratio) + 8;
-        out16k.resize(expected);
-        int produced = (int)to16k.process(ratio, inMono, out16k.data(), expected);
-        out16k.resize(produced);
+    // hostSR -> 16k mono, written straight into caller storage split over up to
+    // two spans (e.g. a ring region). Returns the number of 16k samples produced.
+    int processTo16k(const float* inMono, int numIn, double hostSR,
+                     float* dst1, int max1, float* dst2 = nullptr, int max2 = 0) {
+        setHostRate(hostSR);
+
+        if (down.isPrepared()) {
+            int produced = 0;
+            while (numIn > 0) {
+                int room = 0;
+                float* hist = down.inputWritePointer(room);
+                const int n = std::min(numIn, room);
+                if (n == 0) break;
+                std::memcpy(hist, inMono, sizeof(float) * (size_t) n);
+                down.commitInput(n);
+                inMono += n; numIn -= n;
+                produced = produceInto(down, dst1, max1, dst2, max2, produced);
+            }
+            return produceInto(down, dst1, max1, dst2, max2, produced);
+        }
+
+        const int numOut = std::min(max1 + max2, lagrangeOutputs(toPending, numIn, hostSR / 16000.0));
+        const int first = std::min(numOut, max1);
+        const int used = to16k.process(hostSR / 16000.0, inMono, dst1, first, numIn, 0);
+        if (numOut > first)
+            to16k.process(hostSR / 16000.0, inMono + used, dst2, numOut - first, std::max(0, numIn - used), 0);
+        return numOut;
     }
 
     // 16k mono -> host SR mono
     void processFrom16k(const float* in16k, int numIn, double hostSR, std::vector<float>& outMono) {
-        const double ratio = hostSR / 16000.0;
-        const int expected = (int)std::ceil(numIn * ratio) + 8;
-        outMono.resize(expected);
-        int produced = (int)from16k.process(ratio, in16k, outMono.data(), expected);
-        outMono.resize(produced);
+        setHostRate(hostSR);
+
+        if (up.isPrepared()) {
+            outMono.resize((size_t) up.maxOutFor(numIn));
+            outMono.resize((size_t) up.process(in16k, numIn, outMono.data(), (int) outMono.size()));
+            return;
+        }
+
+        const int numOut = lagrangeOutputs(fromPending, numIn, 16000.0 / hostSR);
+        outMono.resize((size_t) numOut);
+        from16k.process(16000.0 / hostSR, in16k, outMono.data(), numOut, numIn, 0);
+    }
+
+    // Upper bound of 16k samples the next processTo16k() call can produce
+    int maxOutFor(int numIn, double hostSR) {
+        setHostRate(hostSR);
+        if (down.isPrepared())
+            return down.maxOutFor(numIn);
+        return (int)((toPending + numIn) * 16000.0 / hostSR) + 1;
+    }
+
+    void reset() {
+        to16k.reset(); from16k.reset();
+        toPending = fromPending = 0.0;
+        if (down.isPrepared()) down.reset();
+        if (up.isPrepared())   up.reset();
+    }
+
+private:
+    void setHostRate(double hostSR) {
+        if (hostSR == rate) return;
+        rate = hostSR;
+        down.prepare(hostSR, 16000.0);
+        up.prepare(16000.0, hostSR);
+        reset();
+    }
+
+    static int produceInto(PolyphaseResampler& r, float* dst1, int max1, float* dst2, int max2, int produced) {
+        if (produced < max1)
+            produced += r.produce(dst1 + produced, max1 - produced);
+        if (produced >= max1 && dst2 != nullptr)
+            produced += r.produce(dst2 + (produced - max1), max1 + max2 - produced);
+        return produced;
+    }
+
+    // outputs the Lagrange fallback can make from numIn more inputs at 'speed'
+    // input samples per output; carries the fractional position across blocks
+    static int lagrangeOutputs(double& pending, int numIn, double speed) {
+        pending += numIn;
+        const int numOut = (int)(pending / speed);
+        pending -= numOut * speed;
+        return numOut;
     }
 
-    void reset() { to16k.reset(); from16k.reset(); }
+    PolyphaseResampler down, up;
+    juce::LagrangeInterpolator to16k, from16k; // fallback for uncommon host rates
+    double toPending = 0.0, fromPending = 0.0;
+    double rate = 0.0;
 };
@@ -0,0 +1,220 @@
+#pragma once
+#include <algorithm>
+#include <atomic>
+#include <cmath>
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <type_traits>
+#include <vector>
+#include "WakeSignal.h"
+
+// Single-Producer / Single-Consumer lock-free ring of interleaved audio frames.
+//  - T is the stored sample type (float, or int16_t for half-size history)
+//  - Channels is fixed at compile time, so frame strides fold into constants
+//  - capacity is rounded up to a power of two, wrapping is a mask
+//  - read/write indices live on separate cache lines, and each side keeps a
+//    cached copy of the other side's index so it only touches the shared
+//    line when it actually runs out of space/data
+//  - the consumer can block in waitForData(); commitWrite() wakes it without
+//    ever blocking the producer (see WakeSignal), and a parked reader lets the
+//    producer skip silent input entirely
+template <typename T, int Channels>
+class RingBuffer
+{
+    static_assert(Channels > 0, "RingBuffer needs at least one channel");
+    static_assert(std::is_trivially_copyable<T>::value, "RingBuffer stores raw samples");
+
+public:
+    using SampleType = T;
+    static constexpr int numChannels = Channels;
+
+    // Up to two contiguous spans straight into the ring storage
+    // (second one is non-empty only when the region wraps).
+    struct Region
+    {
+        T* data1 = nullptr;  size_t frames1 = 0;
+        T* data2 = nullptr;  size_t frames2 = 0;
+
+        size_t frames() const { return frames1 + frames2; }
+    };
+
+    explicit RingBuffer(size_t capacityFrames)
+        : capacity(nextPowerOfTwo(capacityFrames)),
+          mask(capacity - 1)
+    {
+        buffer.resize(capacity * Channels);
+    }
+
+    size_t push(const T* interleaved, size_t frames)
+    {
+        auto region = prepareWrite(frames);
+        copyFrames(region.data1, interleaved, region.frames1);
+        copyFrames(region.data2, interleaved + region.frames1 * Channels, region.frames2);
+        commitWrite(region.frames());
+        return region.frames();
+    }
+
+    size_t pop(T* interleaved, size_t frames)
+    {
+        auto region = peekRead(frames);
+        copyFrames(interleaved, region.data1, region.frames1);
+        copyFrames(interleaved + region.frames1 * Channels, region.data2, region.frames2);
+        consumeRead(region.frames());
+        return region.frames();
+    }
+
+    // ---- zero-copy producer side ----
+    // Reserve up to 'frames' of free space; fill it in place, then commitWrite().
+    Region prepareWrite(size_t frames)
+    {
+        const size_t w = producer.index.load(std::memory_order_relaxed);
+        if (capacity - (w - producer.cachedOther) < frames)
+            producer.cachedOther = consumer.index.load(std::memory_order_acquire);
+        return makeRegion(w, std::min(frames, capacity - (w - producer.cachedOther)));
+    }
+
+    void commitWrite(size_t frames)
+    {
+        const size_t w = producer.index.load(std::memory_order_relaxed) + frames;
+        producer.index.store(w, std::memory_order_seq_cst);
+
+        // wake the reader once it has what it asked for
+        if (w - consumer.index.load(std::memory_order_relaxed) >= wakeThreshold.load(std::memory_order_seq_cst))
+            dataReady.post();
+    }
+
+    // ---- zero-copy consumer side ----
+    // Look at up to 'frames' of readable audio in place, then consumeRead().
+    Region peekRead(size_t frames)
+    {
+        const size_t r = consumer.index.load(std::memory_order_relaxed);
+        if (consumer.cachedOther - r < frames)
+            consumer.cachedOther = producer.index.load(std::memory_order_acquire);
+        return makeRegion(r, std::min(frames, consumer.cachedOther - r));
+    }
+
+    void consumeRead(size_t frames)
+    {
+        consumer.index.store(consumer.index.load(std::memory_order_relaxed) + frames, std::memory_order_release);
+    }
+
+    // Consumer side: frames ready to read right now
+    size_t availableToRead()
+    {
+        consumer.cachedOther = producer.index.load(std::memory_order_seq_cst);
+        return consumer.cachedOther - consumer.index.load(std::memory_order_relaxed);
+    }
+
+    // ---- wakeups ----
+    // Consumer: block until at least minFrames are readable, wakeReader() is
+    // called, or timeoutMs elapses (< 0 waits forever). Returns true if the
+    // data is there.
+    bool waitForData(size_t minFrames, int timeoutMs)
+    {
+        return waitForData(minFrames, timeoutMs, [] { return false; });
+    }
+
+    // Same, but also returns (false) as soon as stop() is true; stop() is
+    // re-checked after arming, so a wakeReader() that follows setting it
+    // can't be missed.
+    template <typename Stop>
+    bool waitForData(size_t minFrames, int timeoutMs, Stop&& stop)
+    {
+        minFrames = std::min(std::max<size_t>(1, minFrames), capacity);
+        wakeThreshold.store(minFrames, std::memory_order_seq_cst);
+        dataReady.waitUntil([&] { return stop() || availableToRead() >= minFrames; }, timeoutMs);
+        return ! stop() && availableToRead() >= minFrames;
+    }
+
+    // Any thread: kick a blocked reader (e.g. on shutdown)
+    void wakeReader() { dataReady.post(); }
+
+    // A parked reader has gone idle on silence; producers may skip pushing
+    // silent blocks until something audible arrives, which wakes it again.
+    void setReaderParked(bool shouldPark) { readerParked.store(shouldPark, std::memory_order_relaxed); }
+    bool isReaderParked() const { return readerParked.load(std::memory_order_relaxed); }
+
+    // Only safe while neither side is running
+    void clear() {
+        producer.index.store(0, std::memory_order_release);
+        consumer.index.store(0, std::memory_order_release);
+        producer.cachedOther = consumer.cachedOther = 0;
+    }
+
+    size_t capacityFrames() const { return capacity; }
+
+private:
+    static constexpr size_t cacheLine = 64;
+
+    struct alignas(cacheLine) Side
+    {
+        std::atomic<size_t> index { 0 }; // owned by this side, read by the other
+        size_t cachedOther = 0;          // last seen value of the other side's index
+    };
+
+    static size_t nextPowerOfTwo(size_t n)
+    {
+        size_t p = 1;
+        while (p < n) p <<= 1;
+        return p;
+    }
+
+    Region makeRegion(size_t index, size_t frames)
+    {
+        const size_t pos = index & mask;
+        const size_t firstPart = std::min(frames, capacity - pos);
+
+        Region region;
+        region.data1 = &buffer[pos * Channels];
+        region.frames1 = firstPart;
+        region.data2 = buffer.data();
+        region.frames2 = frames - firstPart;
+        return region;
+    }
+
+    static void copyFrames(T* dst, const T* src, size_t frames)
+    {
+        if (frames > 0)
+            std::memcpy(dst, src, frames * Channels * sizeof(T));
+    }
+
+    const size_t capacity;
+    const size_t mask;
+    std::vector<T> buffer;
+
+    Side producer; // writeIndex + cached readIndex
+    Side consumer; // readIndex  + cached writeIndex
+
+    alignas(cacheLine) std::atomic<size_t> wakeThreshold { 1 };
+    std::atomic<bool> readerParked { false };
+    WakeSignal dataReady;
+};
+
+// Sample conversion between the float DSP domain and the ring storage type
+inline void convertSamples(const float* src, float* dst, size_t n)
+{
+    if (n > 0) std::memcpy(dst, src, n * sizeof(float));
+}
+
+inline void convertSamples(const float* src, int16_t* dst, size_t n)
+{
+    for (size_t i = 0; i < n; ++i)
+    {
+        const float s = std::min(1.0f, std::max(-1.0f, src[i]));
+        dst[i] = (int16_t) std::lrintf(s * 32767.0f);
+    }
+}
+
+inline void convertSamples(const int16_t* src, float* dst, size_t n)
+{
+    constexpr float scale = 1.0f / 32768.0f;
+    for (size_t i = 0; i < n; ++i)
+        dst[i] = (float) src[i] * scale;
+}
+
+// 20 s of 16 kHz mono ASR history, stored as int16 for half the footprint
+using AsrRing16k = RingBuffer<int16_t, 1>;
+
+// Host-rate interleaved stereo audio (input tap / TTS out)
+using StereoFifo = RingBuffer<float, 2>;
@@ -0,0 +1,85 @@
+#include "SlidingWindow.h"
+#include <algorithm>
+#include <cstring>
+
+#if defined (__linux__)
+ #include <sys/mman.h>
+ #include <unistd.h>
+#endif
+
+namespace
+{
+#if defined (__linux__)
+    // Maps 'bytes' (a page multiple) of a fresh memfd twice, back to back.
+    // Returns nullptr if anything fails; the caller then uses the copy fallback.
+    float* mapMirrored(size_t bytes)
+    {
+        const int fd = memfd_create("lt-sliding-window", MFD_CLOEXEC);
+        if (fd < 0) return nullptr;
+
+        void* mem = MAP_FAILED;
+        if (ftruncate(fd, (off_t) bytes) == 0)
+        {
+            // reserve 2x address space, then overlay both halves with the file
+            mem = mmap(nullptr, bytes * 2, PROT_NONE, MAP_PRIVATE | MAP_ANONYMOUS, -1, 0);
+            if (mem != MAP_FAILED)
+            {
+                auto* lo = static_cast<char*>(mem);
+                if (mmap(lo,         bytes, PROT_READ | PROT_WRITE, MAP_SHARED | MAP_FIXED, fd, 0) == MAP_FAILED
+                 || mmap(lo + bytes, bytes, PROT_READ | PROT_WRITE, MAP_SHARED | MAP_FIXED, fd, 0) == MAP_FAILED)
+                {
+                    munmap(mem, bytes * 2);
+                    mem = MAP_FAILED;
+                }
+            }
+        }
+        close(fd); // the mappings keep the memory alive
+        return mem == MAP_FAILED ? nullptr : static_cast<float*>(mem);
+    }
+#endif
+}
+
+SlidingWindow::SlidingWindow(size_t minCapacity)
+{
+    minCapacity = std::max<size_t>(minCapacity, 1);
+
+   #if defined (__linux__)
+    const size_t page  = (size_t) sysconf(_SC_PAGESIZE);
+    const size_t bytes = (minCapacity * sizeof(float) + page - 1) / page * page;
+    if ((base = mapMirrored(bytes)) != nullptr)
+    {
+        cap = bytes / sizeof(float);
+        mirrored = true;
+        return;
+    }
+   #endif
+
+    cap = minCapacity;
+    copyMirror.assign(cap * 2, 0.0f);
+    base = copyMirror.data();
+}
+
+SlidingWindow::~SlidingWindow()
+{
+   #if defined (__linux__)
+    if (mirrored)
+        munmap(base, cap * sizeof(float) * 2);
+   #endif
+}
+
+void SlidingWindow::commit(size_t n)
+{
+    n = std::min(n, cap);
+
+    if (! mirrored)
+    {
+        // keep both halves identical: [head, cap) -> upper, [cap, head + n) -> lower
+        const size_t lowerPart = std::min(n, cap - head);
+        std::memcpy(base + head + cap, base + head, lowerPart * sizeof(float));
+        if (n > lowerPart)
+            std::memcpy(base, base + cap, (n - lowerPart) * sizeof(float));
+    }
+
+    head = (head + n) % cap;
+    filled = std::min(cap, filled + n);
+}
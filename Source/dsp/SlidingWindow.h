@@ -0,0 +1,43 @@
+#pragma once
+#include <cstddef>
+#include <vector>
+
+// The most recent N samples as a circular buffer that still hands out a
+// contiguous pointer to its newest samples (whisper_full wants one).
+//  - On Linux the storage is one memfd mapped twice back to back, so a read
+//    or write running off the end lands at the start without any copying.
+//  - Elsewhere the buffer is allocated twice as large and every write is
+//    mirrored into the other half.
+// Either way appending a frame is O(frame) regardless of capacity, so long
+// windows cost nothing extra per frame.
+class SlidingWindow
+{
+public:
+    // Capacity may be rounded up (to a whole number of pages when mirrored)
+    explicit SlidingWindow(size_t minCapacity);
+    ~SlidingWindow();
+
+    size_t capacity() const { return cap; }
+    size_t size() const     { return filled; }
+    bool isMirrored() const { return mirrored; }
+
+    // Space for the next n <= capacity() samples, contiguous; then commit(n)
+    float* writePointer() { return base + head; }
+    void commit(size_t n);
+
+    // Contiguous view of the newest n <= size() samples, oldest first
+    const float* latest(size_t n) const { return base + (head + cap - n); }
+
+    void clear() { filled = 0; }
+
+private:
+    float* base = nullptr;
+    size_t cap = 0;
+    size_t head = 0;    // next write position, 0..cap-1
+    size_t filled = 0;
+    bool mirrored = false;
+    std::vector<float> copyMirror; // fallback storage, 2 * cap
+
+    SlidingWindow(const SlidingWindow&) = delete;
+    SlidingWindow& operator=(const SlidingWindow&) = delete;
+};
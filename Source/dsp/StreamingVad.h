@@ -0,0 +1,142 @@
+#pragma once
+#include <juce_dsp/juce_dsp.h>
+#include <cmath>
+#include <cstdint>
+#include <vector>
+
+// Frame-level streaming voice activity detector for 16 kHz mono.
+// Each 20 ms frame gets energy, zero-crossing rate and spectral flatness;
+// those are turned into a speech probability against an adaptive noise
+// floor, then smoothed with onset/hangover. Per-frame decisions are kept in a
+// running window so "how much speech is in the last N seconds" is O(1).
+struct VadConfig
+{
+    float energyFloor    = 1e-5f; // absolute mean-square floor; below is never speech
+    float threshold      = 0.5f;  // per-frame probability that counts as speech
+    int   onsetFrames    = 3;     // consecutive speech frames to enter speech (60 ms)
+    int   hangoverFrames = 15;    // frames held after speech stops (300 ms)
+    int   windowFrames   = 100;   // span of the running speech count (2 s)
+};
+
+class StreamingVad
+{
+public:
+    static constexpr int frameSize = 320; // 20 ms @ 16k
+
+    explicit StreamingVad(const VadConfig& c = {})
+        : cfg(c), fft(fftOrder), hann((size_t) frameSize, juce::dsp::WindowingFunction<float>::hann, false)
+    {
+        fftData.resize((size_t) fftSize * 2, 0.0f);
+        reset();
+    }
+
+    void setWindowFrames(int frames)
+    {
+        cfg.windowFrames = std::max(1, frames);
+        reset();
+    }
+
+    void reset()
+    {
+        history.assign((size_t) cfg.windowFrames, 0);
+        histPos = 0;
+        speechInWindow = 0;
+        run = 0;
+        hangLeft = 0;
+        inSpeech = false;
+        prob = 0.0f;
+        noiseDb = -60.0f;
+    }
+
+    // Feed one 20 ms frame; returns this frame's speech probability.
+    float processFrame(const float* x)
+    {
+        // energy + zero-crossing rate
+        double e = 0.0;
+        int crossings = 0;
+        for (int i = 0; i < frameSize; ++i)
+        {
+            e += (double) x[i] * x[i];
+            if (i > 0 && ((x[i] >= 0.0f) != (x[i - 1] >= 0.0f))) ++crossings;
+        }
+        energy = (float) (e / frameSize);
+        zcr = (float) crossings / (float) (frameSize - 1);
+        flatness = energy < cfg.energyFloor ? 1.0f : spectralFlatness(x); // skip the FFT on silence
+
+        const float energyDb = 10.0f * std::log10(energy + 1e-12f);
+        const float snrDb = energyDb - noiseDb;
+
+        // combine: loud vs. floor, harmonic (low flatness), not hiss-like (ZCR)
+        const float pEnergy = sigmoid((snrDb - 6.0f) / 2.0f);
+        const float pTonal  = sigmoid((0.45f - flatness) / 0.08f);
+        const float pZcr    = zcr < 0.35f ? 1.0f : 0.3f;
+        prob = energy < cfg.energyFloor ? 0.0f : pEnergy * (0.4f + 0.6f * pTonal) * pZcr;
+
+        // onset / hangover smoothing
+        const bool frameSpeech = prob >= cfg.threshold;
+        run = frameSpeech ? run + 1 : 0;
+        if (frameSpeech && (inSpeech || run >= cfg.onsetFrames)) { inSpeech = true; hangLeft = cfg.hangoverFrames; }
+        else if (inSpeech && ! frameSpeech && --hangLeft <= 0)    inSpeech = false;
+
+        // noise floor: fast down, slow up (~2.5 dB/s), frozen during speech,
+        // never below the absolute floor (digital silence would pin it there)
+        if (energyDb < noiseDb)  noiseDb = 0.7f * noiseDb + 0.3f * energyDb;
+        else if (! inSpeech)     noiseDb = std::min(energyDb, noiseDb + 0.05f);
+        noiseDb = std::max(noiseDb, 10.0f * std::log10(cfg.energyFloor));
+
+        // running count over the window
+        const uint8_t flag = inSpeech ? 1 : 0;
+        speechInWindow += flag - history[(size_t) histPos];
+        history[(size_t) histPos] = flag;
+        histPos = (histPos + 1) % cfg.windowFrames;
+
+        return prob;
+    }
+
+    bool  isSpeech() const              { return inSpeech; }
+    float speechProbability() const     { return prob; }
+    int   speechFramesInWindow() const  { return speechInWindow; }
+    float frameEnergy() const           { return energy; }
+    float frameZcr() const              { return zcr; }
+    float frameFlatness() const         { return flatness; }
+
+private:
+    static constexpr int fftOrder = 9;
+    static constexpr int fftSize  = 1 << fftOrder; // 512, zero-padded frame
+
+    static float sigmoid(float x) { return 1.0f / (1.0f + std::exp(-x)); }
+
+    // geometric / arithmetic mean of the power spectrum over ~100 Hz - 4 kHz
+    float spectralFlatness(const float* x)
+    {
+        std::fill(fftData.begin(), fftData.end(), 0.0f);
+        std::copy(x, x + frameSize, fftData.begin());
+        hann.multiplyWithWindowingTable(fftData.data(), (size_t) frameSize);
+        fft.performFrequencyOnlyForwardTransform(fftData.data(), true);
+
+        constexpr int lo = 3, hi = 128;
+        double logSum = 0.0, sum = 0.0;
+        for (int k = lo; k < hi; ++k)
+        {
+            const double p = (double) fftData[(size_t) k] * fftData[(size_t) k] + 1e-12;
+            logSum += std::log(p);
+            sum += p;
+        }
+        const double n = hi - lo;
+        return (float) (std::exp(logSum / n) / (sum / n));
+    }
+
+    VadConfig cfg;
+    juce::dsp::FFT fft;
+    juce::dsp::WindowingFunction<float> hann;
+    std::vector<float> fftData;
+
+    std::vector<uint8_t> history;
+    int histPos = 0;
+    int speechInWindow = 0;
+
+    int run = 0, hangLeft = 0;
+    bool inSpeech = false;
+    float prob = 0.0f, energy = 0.0f, zcr = 0.0f, flatness = 1.0f;
+    float noiseDb = -60.0f;
+};
@@ -0,0 +1,79 @@
+#include "WakeSignal.h"
+
+#if defined (_WIN32)
+ #ifndef NOMINMAX
+  #define NOMINMAX
+ #endif
+ #include <windows.h>
+#elif defined (__APPLE__)
+ #include <dispatch/dispatch.h>
+#else
+ #include <semaphore.h>
+ #include <cerrno>
+ #include <ctime>
+#endif
+
+// Thin wrapper over the platform counting semaphore. Releasing never blocks
+// on any of them (ReleaseSemaphore / dispatch_semaphore_signal / sem_post).
+struct WakeSignal::Semaphore
+{
+#if defined (_WIN32)
+    HANDLE handle = CreateSemaphoreW(nullptr, 0, 0x7fffffff, nullptr);
+    ~Semaphore() { CloseHandle(handle); }
+
+    void release() { ReleaseSemaphore(handle, 1, nullptr); }
+    bool acquire(int timeoutMs)
+    {
+        return WaitForSingleObject(handle, timeoutMs < 0 ? INFINITE : (DWORD) timeoutMs) == WAIT_OBJECT_0;
+    }
+#elif defined (__APPLE__)
+    dispatch_semaphore_t handle = dispatch_semaphore_create(0);
+    ~Semaphore() { dispatch_release(handle); }
+
+    void release() { dispatch_semaphore_signal(handle); }
+    bool acquire(int timeoutMs)
+    {
+        const auto when = timeoutMs < 0 ? DISPATCH_TIME_FOREVER
+                                        : dispatch_time(DISPATCH_TIME_NOW, (int64_t) timeoutMs * 1000000);
+        return dispatch_semaphore_wait(handle, when) == 0;
+    }
+#else
+    sem_t handle;
+    Semaphore()  { sem_init(&handle, 0, 0); }
+    ~Semaphore() { sem_destroy(&handle); }
+
+    void release() { sem_post(&handle); }
+    bool acquire(int timeoutMs)
+    {
+        if (timeoutMs < 0)
+        {
+            while (sem_wait(&handle) != 0)
+                if (errno != EINTR) return false;
+            return true;
+        }
+
+        timespec ts;
+        clock_gettime(CLOCK_REALTIME, &ts);
+        ts.tv_sec  += timeoutMs / 1000;
+        ts.tv_nsec += (long) (timeoutMs % 1000) * 1000000;
+        if (ts.tv_nsec >= 1000000000) { ts.tv_sec += 1; ts.tv_nsec -= 1000000000; }
+
+        while (sem_timedwait(&handle, &ts) != 0)
+            if (errno != EINTR) return false;
+        return true;
+    }
+#endif
+};
+
+WakeSignal::WakeSignal() : sem(std::make_unique<Semaphore>()) {}
+WakeSignal::~WakeSignal() = default;
+
+void WakeSignal::release() noexcept
+{
+    sem->release();
+}
+
+void WakeSignal::acquire(int timeoutMs)
+{
+    acquired = sem->acquire(timeoutMs);
+}
@@ -0,0 +1,64 @@
+#pragma once
+#include <atomic>
+#include <memory>
+
+// One-consumer wakeup flag backed by an OS counting semaphore.
+//  - post() is wait-free: a single atomic exchange, and it only enters the
+//    kernel (a non-blocking semaphore release) when the consumer is asleep.
+//    Safe to call from the audio thread.
+//  - waitUntil() is for the single consumer thread; it re-checks its
+//    condition after arming, so a post() racing with it is never lost. A
+//    post() that landed while the consumer was awake makes the next wait
+//    return at once instead of sleeping.
+class WakeSignal
+{
+public:
+    WakeSignal();
+    ~WakeSignal();
+
+    void post() noexcept
+    {
+        if (state.exchange(signalled, std::memory_order_seq_cst) == sleeping)
+            release();
+    }
+
+    // Blocks until ready() is true, a post() arrives, or timeoutMs elapses
+    // (timeoutMs < 0 waits forever). Returns ready() on exit.
+    template <typename Ready>
+    bool waitUntil(Ready&& ready, int timeoutMs)
+    {
+        if (ready()) return true;
+
+        // already signalled: that post() was meant for this wait (e.g. stop()
+        // kicking us between our ready() and here), so don't sleep past it
+        const bool posted = state.exchange(sleeping, std::memory_order_seq_cst) == signalled;
+        if (! posted && ! ready())
+            acquire(timeoutMs);
+
+        // Disarm; if a post() already decided to release the semaphore,
+        // swallow that count so the next wait doesn't return spuriously.
+        int expected = sleeping;
+        if (! state.compare_exchange_strong(expected, idle, std::memory_order_seq_cst))
+        {
+            if (! acquired) acquire(-1);
+            state.store(idle, std::memory_order_seq_cst);
+        }
+        acquired = false;
+        return ready();
+    }
+
+private:
+    enum : int { sleeping = -1, idle = 0, signalled = 1 };
+
+    void release() noexcept;
+    void acquire(int timeoutMs);
+
+    std::atomic<int> state { idle };
+    bool acquired = false; // consumer-only
+
+    struct Semaphore;
+    std::unique_ptr<Semaphore> sem;
+
+    WakeSignal(const WakeSignal&) = delete;
+    WakeSignal& operator=(const WakeSignal&) = delete;
+};
@@ -0,0 +1,222 @@
+#include "InferenceScheduler.h"
+#include <algorithm>
+#include <cmath>
+#include <limits>
+#include <juce_core/juce_core.h>
+#if JUCE_LINUX
+ #include <pthread.h>
+ #include <sched.h>
+ #include <unistd.h>
+#endif
+
+namespace
+{
+    // Called by each worker before it runs anything. Without pinning, a Linux
+    // worker goes back to the CPUs the process's main thread may use: it
+    // would otherwise inherit the mask of whichever host thread started it
+    // (an audio thread pinned to one core, say), and pass it on to ggml's
+    // threads. With pinning, the first `reserved` of those CPUs are left out.
+    // Windows threads don't inherit a creator's mask, so only pinning applies
+    // there (and covers the worker's own share of the decode); JUCE has no
+    // affinity API on macOS.
+    void setWorkerAffinity(bool pinAway, int reserved)
+    {
+       #if JUCE_LINUX
+        cpu_set_t allowed;
+        CPU_ZERO(&allowed);
+        if (sched_getaffinity(getpid(), sizeof(allowed), &allowed) != 0)
+            return;
+
+        if (pinAway && CPU_COUNT(&allowed) > reserved)
+            for (int cpu = 0; cpu < CPU_SETSIZE && reserved > 0; ++cpu)
+                if (CPU_ISSET(cpu, &allowed))
+                {
+                    CPU_CLR(cpu, &allowed);
+                    --reserved;
+                }
+
+        pthread_setaffinity_np(pthread_self(), sizeof(allowed), &allowed);
+       #else
+        if (! pinAway)
+            return;
+
+        const int logical = std::min(32, juce::SystemStats::getNumCpus());
+        const int skip = std::min(logical - 1, std::max(0, reserved));
+        uint32_t mask = 0;
+        for (int cpu = skip; cpu < logical; ++cpu) mask |= (uint32_t) 1 << cpu;
+        juce::Thread::setCurrentThreadAffinityMask(mask);
+       #endif
+    }
+}
+
+InferenceScheduler& InferenceScheduler::instance()
+{
+    static InferenceScheduler scheduler;
+    return scheduler;
+}
+
+InferenceScheduler::~InferenceScheduler()
+{
+    // Runs at unload, possibly under the OS loader lock, where joining would
+    // deadlock; the last unregisterStream() has already stopped the workers.
+    // Anything left means an instance leaked its stream.
+    jassert (workers.empty());
+    for (auto& w : workers)
+        w.detach();
+}
+
+void InferenceScheduler::configure(const Config& c)
+{
+    std::unique_lock<std::mutex> lk(mx);
+    if (c.workers == config.workers && c.threadsPerJob == config.threadsPerJob
+        && c.reservedCores == config.reservedCores && c.pinAwayFromReserved == config.pinAwayFromReserved)
+        return;
+
+    doneCv.wait(lk, [this] { return ! stopping; });
+    stopWorkers(lk);
+    config = c;
+    if (! queue.empty())
+        startWorkers();
+}
+
+int InferenceScheduler::registerStream()
+{
+    std::lock_guard<std::mutex> lg(mx);
+    const int id = nextStream++;
+    streams[id] = Stream { 0.0, juce::Time::getMillisecondCounterHiRes() };
+    return id;
+}
+
+void InferenceScheduler::unregisterStream(int stream)
+{
+    std::unique_lock<std::mutex> lk(mx);
+    streams.erase(stream);
+    if (streams.empty())
+        stopWorkers(lk); // queued jobs are drained first
+}
+
+int InferenceScheduler::getThreadsPerJob() const
+{
+    std::lock_guard<std::mutex> lg(mx);
+    return threadsPerJob;
+}
+
+void InferenceScheduler::run(int stream, double deadlineMs, const std::function<void (int)>& fn)
+{
+    std::unique_lock<std::mutex> lk(mx);
+    doneCv.wait(lk, [this] { return ! stopping; }); // old workers still being joined
+    if (workers.empty())
+        startWorkers();
+
+    Job job;
+    job.stream = stream;
+    job.deadline = deadlineMs;
+    job.enqueued = juce::Time::getMillisecondCounterHiRes();
+    job.fn = &fn;
+
+    queue.push_back(&job);
+    workCv.notify_one();
+    doneCv.wait(lk, [&] { return job.done; });
+}
+
+void InferenceScheduler::startWorkers()
+{
+    // budget: all cores but the reserved ones; ~4 ggml threads per decode is
+    // where whisper stops scaling well, so split the budget into that many
+    const int cores  = std::max(1, juce::SystemStats::getNumPhysicalCpus());
+    const int budget = std::max(1, cores - std::max(0, config.reservedCores));
+
+    numWorkers = config.workers > 0 ? config.workers : std::max(1, (budget + 3) / 4);
+    threadsPerJob = config.threadsPerJob > 0 ? config.threadsPerJob : std::max(1, budget / numWorkers);
+
+    stopping = false;
+    for (int i = 0; i < numWorkers; ++i)
+        workers.emplace_back(&InferenceScheduler::workerLoop, this,
+                             config.pinAwayFromReserved, std::max(0, config.reservedCores));
+}
+
+void InferenceScheduler::stopWorkers(std::unique_lock<std::mutex>& lk)
+{
+    if (workers.empty()) return;
+
+    stopping = true;
+    workCv.notify_all();
+    auto toJoin = std::move(workers);
+    workers.clear();
+
+    lk.unlock();
+    for (auto& w : toJoin) w.join();
+    lk.lock();
+    stopping = false;
+    doneCv.notify_all();
+}
+
+void InferenceScheduler::workerLoop(bool pinAway, int reserved)
+{
+    setWorkerAffinity(pinAway, reserved);
+
+    std::unique_lock<std::mutex> lk(mx);
+    for (;;)
+    {
+        workCv.wait(lk, [this] { return stopping || ! queue.empty(); });
+        if (queue.empty())
+            return; // stopping and drained
+
+        Job* job = pickNext(juce::Time::getMillisecondCounterHiRes());
+        const int threads = threadsPerJob;
+        lk.unlock();
+
+        const double t0 = juce::Time::getMillisecondCounterHiRes();
+        (*job->fn)(threads);
+        const double t1 = juce::Time::getMillisecondCounterHiRes();
+
+        lk.lock();
+        auto it = streams.find(job->stream);
+        if (it != streams.end())
+            it->second.served = servedNow(it->second, t1) + (t1 - t0);
+        job->done = true;
+        doneCv.notify_all();
+    }
+}
+
+double InferenceScheduler::servedNow(Stream& s, double now) const
+{
+    s.served *= std::exp2(-(now - s.updated) / serviceHalfLifeMs);
+    s.updated = now;
+    return s.served;
+}
+
+// Starving jobs first (oldest), otherwise earliest deadline, pushed back by
+// how much more worker time the job's stream has had than the least-served one
+InferenceScheduler::Job* InferenceScheduler::pickNext(double now)
+{
+    double minServed = std::numeric_limits<double>::max();
+    for (auto* j : queue)
+    {
+        auto it = streams.find(j->stream);
+        minServed = std::min(minServed, it != streams.end() ? servedNow(it->second, now) : 0.0);
+    }
+
+    auto best = queue.end();
+    double bestKey = std::numeric_limits<double>::max();
+    bool bestStarving = false;
+
+    for (auto j = queue.begin(); j != queue.end(); ++j)
+    {
+        const bool starving = now - (*j)->enqueued > starvationMs;
+        auto it = streams.find((*j)->stream);
+        const double served = it != streams.end() ? it->second.served : 0.0;
+        const double key = starving ? (*j)->enqueued : (*j)->deadline + (served - minServed);
+
+        if (best == queue.end() || (starving && ! bestStarving) || (starving == bestStarving && key < bestKey))
+        {
+            best = j;
+            bestKey = key;
+            bestStarving = starving;
+        }
+    }
+
+    Job* job = *best;
+    queue.erase(best);
+    return job;
+}
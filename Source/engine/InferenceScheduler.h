@@ -0,0 +1,85 @@
+#pragma once
+#include <condition_variable>
+#include <cstdint>
+#include <functional>
+#include <map>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+// Process-wide pool that runs whisper decodes for every plugin instance.
+// Instances submit jobs with a deadline and block until their job has run;
+// a fixed number of workers, each with a fixed ggml thread count, keeps the
+// total inference threads within the core budget however many instances
+// there are. Jobs run earliest-deadline-first, with a fairness penalty for
+// streams that have recently had more worker time and a starvation guard.
+// The workers live while at least one stream is registered: the last
+// unregisterStream() joins them, so nothing is left for the static's
+// destructor to wait on when the plugin binary is unloaded.
+// On Linux a new thread inherits its creator's affinity, and ggml's compute
+// threads are created by the worker, so each worker sets its own mask on
+// start rather than keeping whatever the host thread that started it had.
+class InferenceScheduler
+{
+public:
+    struct Config
+    {
+        int workers = 0;            // concurrent decodes (0 = from the core budget)
+        int threadsPerJob = 0;      // ggml threads per decode (0 = budget / workers)
+        int reservedCores = 1;      // cores left to the host (audio threads, UI)
+        bool pinAwayFromReserved = false; // affinity: keep workers off the first reservedCores CPUs
+    };
+
+    static InferenceScheduler& instance();
+    ~InferenceScheduler();
+
+    // Takes effect once in-flight jobs finish; queued jobs carry over
+    void configure(const Config& c);
+
+    int  registerStream();
+    void unregisterStream(int stream); // the last one stops the workers
+
+    // Runs fn(numThreads) on a worker and waits for it to finish; stream must
+    // be registered.
+    // deadlineMs is on the juce::Time::getMillisecondCounterHiRes() clock.
+    void run(int stream, double deadlineMs, const std::function<void (int numThreads)>& fn);
+
+    int getThreadsPerJob() const;
+
+private:
+    InferenceScheduler() = default;
+
+    struct Job
+    {
+        int stream = 0;
+        double deadline = 0.0, enqueued = 0.0;
+        const std::function<void (int)>* fn = nullptr;
+        bool done = false;
+    };
+
+    struct Stream
+    {
+        double served = 0.0;   // recent worker time (ms), decays with time
+        double updated = 0.0;
+    };
+
+    static constexpr double starvationMs = 2000.0;
+    static constexpr double serviceHalfLifeMs = 5000.0;
+
+    void startWorkers();    // mx held
+    void stopWorkers(std::unique_lock<std::mutex>& lk);
+    void workerLoop(bool pinAway, int reserved);
+    Job* pickNext(double now); // mx held
+    double servedNow(Stream& s, double now) const;
+
+    mutable std::mutex mx;
+    std::condition_variable workCv, doneCv;
+    std::vector<Job*> queue;
+    std::map<int, Stream> streams;
+    int nextStream = 1;
+
+    Config config;
+    int numWorkers = 0, threadsPerJob = 1;
+    std::vector<std::thread> workers;
+    bool stopping = false;
+};
@@ -0,0 +1,131 @@
+#pragma once
+#include <atomic>
+#include <cstdint>
+#include <string>
+
+// Sticky language ID for "auto" input. Whisper's own auto mode pays for an
+// extra encoder + decoder pass on every decode; people rarely switch
+// language mid-sentence, so detect once at speech onset and hand whisper
+// the pinned language after that. Detection runs again only when
+//   - recheckSec has passed since the last one,
+//   - speech resumes after a pause of pauseSec or more (VAD silence, fed
+//     in per frame; time between decodes says nothing, since a long
+//     segment is only decoded at its end), or
+//   - the mean token log-probability drops well below its running level
+//     (a wrong language decodes with low confidence),
+// and a re-check only moves the pin when the new language beats the pinned
+// one by switchMargin in detection probability.
+// Times are on the engine's 16 kHz sample clock. Worker thread only, apart
+// from getStats().
+class LanguageTracker
+{
+public:
+    struct Config
+    {
+        float recheckSec = 30.0f;
+        float pauseSec = 3.0f;
+        float logProbDrop = 0.6f;   // nats below the running mean that force a re-check
+        float switchMargin = 0.2f;  // probability lead needed to leave the pinned language
+    };
+
+    struct Stats
+    {
+        uint64_t detections = 0, pinnedDecodes = 0, switches = 0;
+    };
+
+    LanguageTracker() : LanguageTracker(Config {}) {}
+    explicit LanguageTracker(const Config& c) : config(c) {}
+
+    void setConfig(const Config& c) { config = c; }
+
+    // Before a decode: true = run detection this time
+    bool shouldDetect(uint64_t now) const
+    {
+        return pinned.empty()
+            || recheckPending
+            || now - lastDetection >= seconds(config.recheckSec);
+    }
+
+    // Every VAD frame: speech starting after pauseSec or more of silence
+    // forces a re-check on the next decode
+    void onVadFrame(bool speech, uint64_t now)
+    {
+        if (speech && ! inSpeech && ! pinned.empty() && now - lastSpeech >= seconds(config.pauseSec))
+            recheckPending = true;
+        if (speech)
+            lastSpeech = now;
+        inSpeech = speech;
+    }
+
+    // Result of a detection pass: the top language and its probability, and
+    // the probability the same pass gave the pinned language. Returns the
+    // language to decode with.
+    const std::string& onDetection(const std::string& best, float bestProb, float pinnedProb, uint64_t now)
+    {
+        ++detections;
+        lastDetection = now;
+        recheckPending = false;
+
+        if (pinned.empty())
+        {
+            pinned = best;
+        }
+        else if (best != pinned && bestProb - pinnedProb >= config.switchMargin)
+        {
+            pinned = best;
+            ++switches;
+            haveLevel = false; // the old language's confidence says nothing about the new one
+        }
+        return pinned;
+    }
+
+    // After every decode in auto mode, with the mean log-probability of its text tokens
+    void onDecoded(bool detected, bool hasTokens, float meanLogProb)
+    {
+        if (! detected)
+            ++pinnedDecodes;
+        if (! hasTokens)
+            return;
+
+        if (haveLevel && meanLogProb < level - config.logProbDrop)
+        {
+            recheckPending = true; // keep the level: one bad decode shouldn't lower the bar
+            return;
+        }
+        level = haveLevel ? level + 0.2f * (meanLogProb - level) : meanLogProb;
+        haveLevel = true;
+    }
+
+    const std::string& language() const { return pinned; }
+
+    void reset()
+    {
+        pinned.clear();
+        recheckPending = false;
+        haveLevel = false;
+        inSpeech = false;
+        lastDetection = lastSpeech = 0;
+    }
+
+    Stats getStats() const
+    {
+        Stats s;
+        s.detections = detections;
+        s.pinnedDecodes = pinnedDecodes;
+        s.switches = switches;
+        return s;
+    }
+
+private:
+    static uint64_t seconds(float s) { return (uint64_t) (s * 16000.0f); }
+
+    Config config;
+    std::string pinned;
+    bool recheckPending = false;
+    bool haveLevel = false;
+    bool inSpeech = false;
+    float level = 0.0f;
+    uint64_t lastDetection = 0, lastSpeech = 0;
+
+    std::atomic<uint64_t> detections { 0 }, pinnedDecodes { 0 }, switches { 0 };
+};
@@ -0,0 +1,151 @@
+#pragma once
+#include <algorithm>
+#include <cstdint>
+#include <string>
+#include <vector>
+
+// One decoded token, placed on the absolute 16 kHz sample timeline
+struct TimedToken
+{
+    int id = 0;
+    std::string text;
+    uint64_t t0 = 0, t1 = 0;
+};
+
+// LocalAgreement-2 commit policy for overlapping re-decodes.
+// Each hypothesis covers audio from committedUpTo() onwards. The prefix two
+// consecutive hypotheses agree on (same token, start time within tolerance)
+// is committed and never revised; everything after it stays tentative. The
+// caller trims committed audio by starting its next decode at committedUpTo().
+class LocalAgreement
+{
+public:
+    struct Update
+    {
+        std::string committed;  // newly committed text, empty if nothing agreed yet
+        std::string tentative;  // current unstable tail
+        uint64_t committedStart = 0, committedEnd = 0;
+    };
+
+    explicit LocalAgreement(uint64_t toleranceSamples = 8000) : tolerance(toleranceSamples) {}
+
+    uint64_t committedUpTo() const { return committedEnd; }
+    bool hasTentative() const      { return ! previous.empty(); }
+
+    void reset(uint64_t atSample)
+    {
+        committedEnd = atSample;
+        previous.clear();
+        recent.clear();
+    }
+
+    // New hypothesis for the uncommitted audio: commit what it shares with the last one
+    Update insert(std::vector<TimedToken> hyp)
+    {
+        dropRepeatedHead(hyp);
+
+        size_t n = 0;
+        while (n < hyp.size() && n < previous.size() && agree(hyp[n], previous[n]))
+            ++n;
+        n = completeCodepoints(hyp, n);
+
+        Update u = commit(hyp, n);
+        previous.assign(hyp.begin() + (std::ptrdiff_t) n, hyp.end());
+        u.tentative = join(previous, previous.size());
+        return u;
+    }
+
+    // End of utterance: commit the final hypothesis as it stands
+    Update flush(std::vector<TimedToken> hyp)
+    {
+        dropRepeatedHead(hyp);
+        previous.clear();
+        return commit(hyp, hyp.size());
+    }
+
+    // Commit the current tentative tail without a new decode
+    Update flush()
+    {
+        auto tail = std::move(previous);
+        previous.clear();
+        return commit(tail, tail.size());
+    }
+
+private:
+    static constexpr size_t maxOverlap = 5; // tokens compared when de-duplicating
+
+    bool agree(const TimedToken& a, const TimedToken& b) const
+    {
+        const uint64_t d = a.t0 > b.t0 ? a.t0 - b.t0 : b.t0 - a.t0;
+        return a.id == b.id && d <= tolerance;
+    }
+
+    // The trim point is only as good as the token timestamps, so a decode
+    // can start by repeating the last committed words; drop those.
+    void dropRepeatedHead(std::vector<TimedToken>& hyp) const
+    {
+        if (hyp.empty() || recent.empty() || hyp.front().t0 > committedEnd + 2 * tolerance)
+            return;
+
+        for (size_t k = std::min({ maxOverlap, recent.size(), hyp.size() }); k > 0; --k)
+        {
+            bool same = true;
+            for (size_t i = 0; i < k && same; ++i)
+                same = recent[recent.size() - k + i] == hyp[i].id;
+            if (same)
+            {
+                hyp.erase(hyp.begin(), hyp.begin() + (std::ptrdiff_t) k);
+                return;
+            }
+        }
+    }
+
+    // Byte-level BPE can split a UTF-8 character across tokens; never
+    // commit half of one.
+    static size_t completeCodepoints(const std::vector<TimedToken>& hyp, size_t n)
+    {
+        while (n > 0)
+        {
+            const std::string text = join(hyp, n);
+            size_t cont = 0, i = text.size();
+            while (i > 0 && cont < 4 && ((unsigned char) text[i - 1] & 0xC0) == 0x80) { --i; ++cont; }
+            if (i == 0) return n;
+
+            const auto lead = (unsigned char) text[i - 1];
+            const size_t need = lead >= 0xF0 ? 3 : lead >= 0xE0 ? 2 : lead >= 0xC0 ? 1 : 0;
+            if (cont >= need) return n;
+            --n;
+        }
+        return 0;
+    }
+
+    Update commit(const std::vector<TimedToken>& hyp, size_t n)
+    {
+        Update u;
+        u.committedStart = u.committedEnd = committedEnd;
+        if (n == 0) return u;
+
+        u.committed = join(hyp, n);
+        u.committedStart = hyp.front().t0;
+        u.committedEnd = committedEnd = std::max(committedEnd, hyp[n - 1].t1);
+
+        for (size_t i = 0; i < n; ++i)
+            recent.push_back(hyp[i].id);
+        if (recent.size() > maxOverlap)
+            recent.erase(recent.begin(), recent.end() - (std::ptrdiff_t) maxOverlap);
+        return u;
+    }
+
+    static std::string join(const std::vector<TimedToken>& tokens, size_t n)
+    {
+        std::string s;
+        for (size_t i = 0; i < n; ++i)
+            s += tokens[i].text;
+        return s;
+    }
+
+    uint64_t tolerance;
+    uint64_t committedEnd = 0;
+    std::vector<TimedToken> previous; // last hypothesis' uncommitted tail
+    std::vector<int> recent;          // ids of the last few committed tokens
+};
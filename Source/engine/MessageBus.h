@@ -1,5 +1,6 @@
 #pragma once
 #include <atomic>
+#include <functional>
 #include <mutex>
 #include <queue>
 #include <string>
@@ -9,6 +10,8 @@ struct TranscriptMsg {
     bool isFinal = false;
     double t0Sec = 0.0, t1Sec = 0.0;
     std::string text;
+    std::string lang;   // detected source language, "" if unknown
+    std::string route;  // finals: how the utterance was routed (RoutePlanner::name)
 };
 
 struct TtsPcmMsg {
@@ -19,9 +22,12 @@ struct TtsPcmMsg {
 
 class MessageBus {
 public:
-    // transcripts
+    // transcripts: the most recent maxTranscripts; when nobody reads them
+    // the oldest go first
     void pushTranscript(const TranscriptMsg& m) {
         std::lock_guard<std::mutex> lg(txMutex);
+        if (transcripts.size() >= maxTranscripts)
+            transcripts.pop();
         transcripts.push(m);
     }
     bool popTranscript(TranscriptMsg& out) {
@@ -32,9 +38,16 @@ public:
         return true;
     }
 
-    // TTS audio
+    // TTS audio: with a sink set (the processor's playback writer) chunks go
+    // straight to it, in order, on the thread that produced them; otherwise
+    // they queue for popTts()
+    void setTtsSink(std::function<void(const TtsPcmMsg&)> sink) {
+        std::lock_guard<std::mutex> lg(ttsMutex);
+        ttsSink = std::move(sink);
+    }
     void pushTts(const TtsPcmMsg& m) {
         std::lock_guard<std::mutex> lg(ttsMutex);
+        if (ttsSink) { ttsSink(m); return; }
         ttsPcm.push(m);
     }
     bool popTts(TtsPcmMsg& out) {
@@ -45,8 +58,11 @@ public:
         return true;
     }
 
+    static constexpr size_t maxTranscripts = 256;
+
 private:
     std::mutex txMutex, ttsMutex;
     std::queue<TranscriptMsg> transcripts;
     std::queue<TtsPcmMsg> ttsPcm;
+    std::function<void(const TtsPcmMsg&)> ttsSink;
 };
@@ -0,0 +1,220 @@
+#include "ModelCalibrator.h"
+#include <algorithm>
+#include <thread>
+#include "WhisperModelRegistry.h"
+
+namespace
+{
+    // -1 = not a file we rank
+    int sizeRank(const juce::String& name)
+    {
+        if (name.startsWith("ggml-tiny"))  return 0;
+        if (name.startsWith("ggml-base"))  return 1;
+        if (name.startsWith("ggml-small")) return 2;
+        return -1;
+    }
+
+    // suffix after "ggml-<size>-"; a plain file is f16
+    int quantRank(const juce::String& quant)
+    {
+        if (quant.isEmpty())  return 2;
+        if (quant == "q8_0")  return 1;
+        if (quant == "q5_1")  return 0;
+        return -1;
+    }
+
+    juce::CriticalSection calibrationLock; // one calibration per process at a time
+}
+
+std::vector<juce::File> ModelCalibrator::findCandidates(const juce::File& modelDir)
+{
+    struct Ranked { juce::File file; int size, quant; bool english; };
+    std::vector<Ranked> ranked;
+
+    for (const auto& f : modelDir.findChildFiles(juce::File::findFiles, false, "ggml-*.bin"))
+    {
+        const auto name = f.getFileNameWithoutExtension();            // e.g. ggml-base.en-q8_0
+        const auto stem = name.replace(".en", "");                     //      ggml-base-q8_0
+        const auto quant = stem.fromFirstOccurrenceOf("-", false, false)
+                               .fromFirstOccurrenceOf("-", false, false); //      q8_0
+        const int s = sizeRank(stem), q = quantRank(quant);
+        if (s >= 0 && q >= 0)
+            ranked.push_back({ f, s, q, name.contains(".en") });
+    }
+
+    // bigger model first, then less quantised; multilingual before .en on ties
+    // (the pipeline auto-detects the input language)
+    std::sort(ranked.begin(), ranked.end(), [] (const Ranked& a, const Ranked& b)
+    {
+        if (a.size != b.size)   return a.size > b.size;
+        if (a.quant != b.quant) return a.quant > b.quant;
+        return ! a.english && b.english;
+    });
+
+    std::vector<juce::File> out;
+    for (auto& r : ranked) out.push_back(r.file);
+    return out;
+}
+
+ModelCalibrator::Result ModelCalibrator::select(const juce::File& modelDir, double targetRtf, const LogFn& log,
+                                                const CancelFn& cancelled)
+{
+    const auto stop = [&] { return cancelled && cancelled(); };
+
+    // another instance may be calibrating; wait for its result, but not
+    // past our own cancellation
+    while (! calibrationLock.tryEnter())
+    {
+        if (stop())
+            return {};
+        juce::Thread::sleep(50);
+    }
+    struct Exit { ~Exit() { calibrationLock.exit(); } } exitOnReturn;
+
+    if (auto c = cached(modelDir, targetRtf); c.isValid())
+        return c;
+
+    const auto candidates = findCandidates(modelDir);
+    if (candidates.empty())
+        return {};
+
+    const int hw = (int) std::max(1u, std::thread::hardware_concurrency());
+    std::vector<int> threadCounts { 2, 4, hw / 2, hw };
+    for (auto& t : threadCounts) t = juce::jlimit(1, hw, t);
+    std::sort(threadCounts.begin(), threadCounts.end());
+    threadCounts.erase(std::unique(threadCounts.begin(), threadCounts.end()), threadCounts.end());
+
+    log("Calibrating ASR models (target RTF " + juce::String(targetRtf, 2) + ")");
+
+    // most accurate first; stop at the first that keeps up. If none does,
+    // fall back to the fastest configuration measured.
+    Result best, fastest;
+    for (const auto& model : candidates)
+    {
+        if (stop())
+            return {};
+
+        // loaded once for all thread counts
+        auto weights = WhisperModelRegistry::acquire(model.getFullPathName().toStdString(), whisper_context_default_params());
+        whisper_state* state = weights ? whisper_init_state(weights.get()) : nullptr;
+        if (state == nullptr)
+            continue; // failed to load
+
+        Result r { model.getFullPathName().toStdString(), 0, 1.0e9 };
+        for (int t : threadCounts)
+        {
+            const double rtf = measure(weights.get(), state, model.getFileName(), t, log, cancelled);
+            if (rtf > 0.0 && rtf < r.rtf) { r.rtf = rtf; r.threads = t; }
+        }
+        whisper_free_state(state);
+
+        if (stop())
+            return {}; // a half-measured set would skew the pick
+        if (r.threads == 0) continue;
+
+        if (! fastest.isValid() || r.rtf < fastest.rtf) fastest = r;
+        if (r.rtf <= targetRtf) { best = r; break; }
+    }
+    if (! best.isValid()) best = fastest;
+
+    if (best.isValid())
+        store(modelDir, targetRtf, best);
+    return best;
+}
+
+double ModelCalibrator::measure(whisper_context* ctx, whisper_state* state, const juce::String& name, int threads,
+                                const LogFn& log, const CancelFn& cancelled)
+{
+    const auto stop = [&] { return cancelled && cancelled(); };
+
+    // low-level noise; the timing doesn't depend on content since the encoder
+    // always sees 30 s and the decode runs a fixed number of steps
+    std::vector<float> clip((size_t) (clipSec * 16000.0));
+    juce::Random rng(1234);
+    for (auto& s : clip) s = (rng.nextFloat() - 0.5f) * 0.01f;
+
+    const int nVocab = whisper_n_vocab(ctx);
+    double encodeMs = 0.0, decodeMs = 0.0;
+
+    auto run = [&]
+    {
+        if (whisper_pcm_to_mel_with_state(ctx, state, clip.data(), (int) clip.size(), threads) != 0)
+            return false;
+
+        const double t0 = juce::Time::getMillisecondCounterHiRes();
+        if (whisper_encode_with_state(ctx, state, 0, threads) != 0)
+            return false;
+        const double t1 = juce::Time::getMillisecondCounterHiRes();
+
+        whisper_token tok = whisper_token_sot(ctx);
+        for (int i = 0; i < decodeSteps; ++i)
+        {
+            if (stop())
+                return false;
+            if (whisper_decode_with_state(ctx, state, &tok, 1, i, threads) != 0)
+                return false;
+            const float* logits = whisper_get_logits_from_state(state);
+            tok = (whisper_token) (std::max_element(logits, logits + nVocab) - logits);
+        }
+        const double t2 = juce::Time::getMillisecondCounterHiRes();
+
+        encodeMs = t1 - t0;
+        decodeMs = t2 - t1;
+        return true;
+    };
+
+    // first pass allocates the graphs; time the second
+    const bool ok = ! stop() && run() && ! stop() && run();
+    if (! ok) return -1.0;
+
+    const double rtf = (encodeMs + decodeMs) / (clipSec * 1000.0);
+    log("  " + name + " x" + juce::String(threads)
+        + ": encode " + juce::String(juce::roundToInt(encodeMs)) + " ms, "
+        + juce::String(decodeSteps) + " tokens " + juce::String(juce::roundToInt(decodeMs)) + " ms, RTF "
+        + juce::String(rtf, 3));
+    return rtf;
+}
+
+// Same machine + same set of model files + same target -> same answer
+juce::String ModelCalibrator::cacheKey(const juce::File& modelDir, double targetRtf)
+{
+    juce::String id;
+    id << juce::SystemStats::getCpuModel() << "|" << juce::SystemStats::getNumCpus() << "|" << targetRtf;
+    for (const auto& f : findCandidates(modelDir))
+        id << "|" << f.getFullPathName() << ":" << f.getSize();
+    return "asr." + juce::String::toHexString(id.hashCode64());
+}
+
+std::unique_ptr<juce::PropertiesFile> ModelCalibrator::openCache()
+{
+    juce::PropertiesFile::Options o;
+    o.applicationName     = "LiveTranslator";
+    o.filenameSuffix      = ".settings";
+    o.folderName          = "LiveTranslator";
+    o.osxLibrarySubFolder = "Application Support";
+    return std::make_unique<juce::PropertiesFile>(o);
+}
+
+ModelCalibrator::Result ModelCalibrator::cached(const juce::File& modelDir, double targetRtf)
+{
+    const auto key = cacheKey(modelDir, targetRtf);
+    auto props = openCache();
+
+    Result r;
+    r.modelPath = props->getValue(key + ".model").toStdString();
+    r.threads   = props->getIntValue(key + ".threads");
+    r.rtf       = props->getDoubleValue(key + ".rtf");
+    if (r.modelPath.empty() || ! juce::File(juce::String(r.modelPath)).existsAsFile())
+        return {};
+    return r;
+}
+
+void ModelCalibrator::store(const juce::File& modelDir, double targetRtf, const Result& result)
+{
+    const auto key = cacheKey(modelDir, targetRtf);
+    auto props = openCache();
+    props->setValue(key + ".model", juce::String(result.modelPath));
+    props->setValue(key + ".threads", result.threads);
+    props->setValue(key + ".rtf", result.rtf);
+    props->saveIfNeeded();
+}
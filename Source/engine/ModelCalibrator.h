@@ -0,0 +1,54 @@
+#pragma once
+#include <functional>
+#include <memory>
+#include <string>
+#include <vector>
+#include <juce_core/juce_core.h>
+#include <juce_data_structures/juce_data_structures.h>
+
+struct whisper_context;
+struct whisper_state;
+
+// First-run model / thread-count selection.
+// Times the encoder and a short greedy decode for every ggml model file found
+// (tiny/base/small, f16/q8_0/q5_1) at a few thread counts, then picks the most
+// accurate configuration whose real-time factor stays under the target. The
+// choice is cached per machine, so later instances just read it back. Each
+// candidate is loaded once for all of its thread counts, and a calibration
+// can be abandoned between timing runs (nothing is cached then).
+class ModelCalibrator
+{
+public:
+    struct Result
+    {
+        std::string modelPath;
+        int threads = 0;
+        double rtf = 0.0; // (encode + decode) time / audio time of the reference clip
+
+        bool isValid() const { return ! modelPath.empty(); }
+    };
+
+    using LogFn = std::function<void (const juce::String&)>;
+    using CancelFn = std::function<bool ()>; // true = give up
+
+    // Cached choice for this machine and model set, calibrating first if there
+    // is none. Invalid if cancelled returned true before a choice was made.
+    static Result select(const juce::File& modelDir, double targetRtf, const LogFn& log,
+                         const CancelFn& cancelled = {});
+
+    // Cached choice only; invalid if this machine hasn't been calibrated yet
+    static Result cached(const juce::File& modelDir, double targetRtf);
+    static void store(const juce::File& modelDir, double targetRtf, const Result& result);
+
+    // Model files we know how to rank, most accurate first
+    static std::vector<juce::File> findCandidates(const juce::File& modelDir);
+
+private:
+    static constexpr double clipSec = 5.0; // reference utterance
+    static constexpr int decodeSteps = 24; // ~tokens in 5 s of speech
+
+    static double measure(whisper_context* ctx, whisper_state* state, const juce::String& name, int threads,
+                          const LogFn& log, const CancelFn& cancelled);
+    static juce::String cacheKey(const juce::File& modelDir, double targetRtf);
+    static std::unique_ptr<juce::PropertiesFile> openCache();
+};
@@ -0,0 +1,67 @@
+#include "OutputStages.h"
+
+OutputStages::OutputStages(ITranslator& tr, ITts& t, MessageBus& b, const Config& config)
+: translator(tr), tts(t), bus(b),
+  ttsStage("tts", config.ttsDepth, config.ttsPolicy, [this](TtsRequest& r) { speakOne(r); }),
+  translateStage("translate", config.translateDepth, config.translatePolicy, config.translateBatch,
+                 [this](std::vector<TranslateRequest>& batch) { translateSome(batch); })
+{
+}
+
+bool OutputStages::submit(const TranslateRequest& r)
+{
+    return translateStage.push(r);
+}
+
+bool OutputStages::speak(const TtsRequest& r)
+{
+    return ttsStage.push(r);
+}
+
+void OutputStages::clear()
+{
+    translateStage.clear();
+    ttsStage.clear();
+}
+
+void OutputStages::setVoice(const std::string& voice, const std::string& style)
+{
+    std::lock_guard<std::mutex> lock(voiceLock);
+    voiceName = voice;
+    voiceStyle = style;
+}
+
+OutputStages::Stats OutputStages::getStats() const
+{
+    return { translateStage.getStats(), ttsStage.getStats() };
+}
+
+void OutputStages::translateSome(std::vector<TranslateRequest>& batch)
+{
+    auto translated = translator.translateBatch(batch);
+    for (size_t i = 0; i < batch.size() && i < translated.size(); ++i)
+    {
+        TtsRequest req;
+        req.text = std::move(translated[i]);
+        if (onTranslated)
+            onTranslated(batch[i].text, req.text);
+        if (req.text.empty())
+            continue;
+
+        ttsStage.push(std::move(req));
+    }
+}
+
+void OutputStages::speakOne(TtsRequest& r)
+{
+    if (r.voice.empty())
+    {
+        std::lock_guard<std::mutex> lock(voiceLock);
+        r.voice = voiceName;
+        r.style = voiceStyle;
+    }
+
+    tts.synthesize(r, [this](const std::vector<float>& chunk, bool eof) {
+        TtsPcmMsg m; m.pcm16k = chunk; m.eof = eof; bus.pushTts(m);
+    });
+}
@@ -0,0 +1,67 @@
+#pragma once
+#include <functional>
+#include <mutex>
+#include <string>
+#include "MessageBus.h"
+#include "StageWorker.h"
+#include "../translate/ITranslator.h"
+#include "../tts/ITts.h"
+
+// Translate -> TTS for final transcripts, off the ASR thread. Each stage has
+// its own thread and bounded queue, so utterance N is being translated and
+// spoken while N+1 is decoded; synthesized PCM lands on the MessageBus.
+// Whatever piled up in the translate queue goes out as one translateBatch(),
+// so a batching translator below gets more than one segment at a time.
+class OutputStages
+{
+public:
+    struct Config
+    {
+        size_t translateDepth = 16;
+        Backpressure translatePolicy = Backpressure::dropOldest;
+        size_t translateBatch = 8; // queued utterances handed to translateBatch() together
+        size_t ttsDepth = 4;      // queued utterances waiting to be spoken
+        Backpressure ttsPolicy = Backpressure::dropOldest;
+    };
+
+    struct Stats
+    {
+        StageStats translate, tts;
+    };
+
+    using OnTranslatedFn = std::function<void (const std::string& src, const std::string& translated)>;
+
+    OutputStages(ITranslator& translator, ITts& tts, MessageBus& bus, const Config& config);
+    OutputStages(ITranslator& translator, ITts& tts, MessageBus& bus) : OutputStages(translator, tts, bus, Config {}) {}
+
+    // Never waits for translation or synthesis; false if the backlog dropped something
+    bool submit(const TranslateRequest& r);
+    // Text already in the target language: straight to TTS
+    bool speak(const TtsRequest& r);
+    void clear();
+
+    // Voice and speaking style for requests that don't name their own; any thread
+    void setVoice(const std::string& voice, const std::string& style);
+
+    Stats getStats() const;
+
+    // Called on the translate thread (logging / display)
+    void setOnTranslated(OnTranslatedFn fn) { onTranslated = std::move(fn); }
+
+private:
+    void translateSome(std::vector<TranslateRequest>& batch);
+    void speakOne(TtsRequest& r);
+
+    ITranslator& translator;
+    ITts& tts;
+    MessageBus& bus;
+    OnTranslatedFn onTranslated;
+
+    std::mutex voiceLock;
+    std::string voiceName, voiceStyle;
+
+    // declared in consumer-first order, so translate's thread is joined
+    // before the stage it feeds goes away
+    StageWorker<TtsRequest> ttsStage;
+    StageWorker<TranslateRequest> translateStage;
+};
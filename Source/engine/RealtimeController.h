@@ -0,0 +1,105 @@
+#pragma once
+#include <algorithm>
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+
+// Keeps ASR latency bounded on machines that can't decode in real time.
+// After every decode, decode time is compared with the budget and with the
+// audio that arrived since the previous decode; a smoothed load above 1 steps
+// the degradation level up, a sustained load well below 1 steps it back down:
+//   0  normal
+//   1  encoder context fitted to the decoded audio (audio_ctx)
+//   2  + hop x2, no interim decodes
+//   3  + hop x4, half-length decode window / segments
+// Independently, backlog beyond maxBacklog is dropped (oldest first).
+// Worker thread only, apart from the budget and the stats.
+class RealtimeController
+{
+public:
+    static constexpr int maxLevel = 3;
+
+    struct Stats
+    {
+        int level = 0;
+        float load = 0.0f;        // smoothed decode time / min(budget, audio time)
+        uint64_t droppedSamples = 0;
+        uint32_t dropEvents = 0;
+    };
+
+    void setBudgetMs(int ms)      { budgetMs.store(std::max(1, ms), std::memory_order_relaxed); }
+    int  getBudgetMs() const      { return budgetMs.load(std::memory_order_relaxed); }
+    void setMaxBacklog(size_t samples) { maxBacklog = std::max<size_t>(samples, 16000 / 2); }
+
+    // decodeMs: wall time of the decode; audioMs: audio that arrived since the
+    // previous decode started; backlogMs: audio still queued after this one
+    void onDecode(double decodeMs, double audioMs, double backlogMs)
+    {
+        const double allowed = std::max(1.0, std::min((double) budgetMs.load(std::memory_order_relaxed), audioMs));
+        ema = decodes++ == 0 ? decodeMs / allowed : 0.7 * ema + 0.3 * (decodeMs / allowed);
+        ++sinceChange;
+
+        // falling behind: either decodes are too slow or the queue is growing
+        const bool over = ema > 1.0 || backlogMs > 0.5 * (double) maxBacklog / 16.0; // half of maxBacklog
+        if (over && level < maxLevel && sinceChange >= 2)
+            setLevel(level + 1);
+        else if (! over && ema < 0.5 && level > 0 && sinceChange >= 10)
+            setLevel(level - 1);
+
+        stats.load.store((float) ema, std::memory_order_relaxed);
+    }
+
+    // Samples to discard from the front of the queue (0 if we're keeping up).
+    // Keeps the newest quarter of maxBacklog, in whole 20 ms frames.
+    size_t staleSamples(size_t queued)
+    {
+        if (queued <= maxBacklog) return 0;
+        const size_t drop = (queued - maxBacklog / 4) / 320 * 320;
+        stats.droppedSamples.fetch_add(drop, std::memory_order_relaxed);
+        stats.dropEvents.fetch_add(1, std::memory_order_relaxed);
+        if (level < maxLevel) setLevel(maxLevel); // clearly can't keep up
+        return drop;
+    }
+
+    int getLevel() const { return level; }
+
+    // knobs for the current level
+    bool fitAudioContext() const { return level >= 1; }
+    bool allowInterims() const   { return level < 2; }
+    int  hopScale() const        { return level >= 3 ? 4 : level == 2 ? 2 : 1; }
+    int  spanDivisor() const     { return level >= 3 ? 2 : 1; }
+
+    Stats getStats() const
+    {
+        Stats s;
+        s.level = stats.level.load(std::memory_order_relaxed);
+        s.load = stats.load.load(std::memory_order_relaxed);
+        s.droppedSamples = stats.droppedSamples.load(std::memory_order_relaxed);
+        s.dropEvents = stats.dropEvents.load(std::memory_order_relaxed);
+        return s;
+    }
+
+private:
+    void setLevel(int l)
+    {
+        level = l;
+        sinceChange = 0;
+        stats.level.store(l, std::memory_order_relaxed);
+    }
+
+    std::atomic<int> budgetMs { 400 };
+    size_t maxBacklog = 16000 * 3 / 2;
+
+    int level = 0;
+    double ema = 0.0;
+    uint64_t decodes = 0;
+    int sinceChange = 0;
+
+    struct
+    {
+        std::atomic<int> level { 0 };
+        std::atomic<float> load { 0.0f };
+        std::atomic<uint64_t> droppedSamples { 0 };
+        std::atomic<uint32_t> dropEvents { 0 };
+    } stats;
+};
@@ -0,0 +1,100 @@
+#pragma once
+#include <array>
+#include <atomic>
+#include <cstdint>
+#include <string>
+#include <juce_core/juce_core.h>
+
+// Cheapest path from a recognised utterance to output, chosen per utterance
+// from the language whisper actually detected:
+//   passThrough       source == target: nothing to translate or speak
+//   whisperTranslate  X -> English: whisper's own translate task produced the
+//                     English text in the decode, so only TTS is left
+//   machineTranslate  anything else: the configured ITranslator, then TTS
+enum class Route { passThrough, whisperTranslate, machineTranslate };
+
+class RoutePlanner
+{
+public:
+    struct Stats
+    {
+        std::array<uint64_t, 3> utterances {};  // indexed by Route
+        uint64_t charsNotTranslated = 0;        // text that never went to the MT backend
+    };
+
+    // Before a decode: let whisper translate into English itself? Only a
+    // multilingual model can, and only worth it when the source isn't
+    // already known to be English.
+    bool useWhisperTranslate(const std::string& srcLang, const std::string& dstLang, bool multilingual) const
+    {
+        return whisperTranslate.load() && multilingual && dstLang == "en" && srcLang != "en";
+    }
+
+    // After the decode, with the detected language ("" if unknown)
+    Route plan(const std::string& detected, const std::string& dstLang, bool whisperTranslated) const
+    {
+        if (! detected.empty() && sameLanguage(detected, dstLang))
+            return Route::passThrough;
+        if (whisperTranslated && dstLang == "en")
+            return Route::whisperTranslate;
+        return Route::machineTranslate;
+    }
+
+    void record(Route r, size_t chars)
+    {
+        ++counts[(size_t) r];
+        if (r != Route::machineTranslate)
+            skippedChars += chars;
+    }
+
+    Stats getStats() const
+    {
+        Stats s;
+        for (size_t i = 0; i < s.utterances.size(); ++i)
+            s.utterances[i] = counts[i].load();
+        s.charsNotTranslated = skippedChars.load();
+        return s;
+    }
+
+    void setWhisperTranslateEnabled(bool enabled) { whisperTranslate.store(enabled); }
+
+    static const char* name(Route r)
+    {
+        switch (r)
+        {
+            case Route::passThrough:      return "pass-through";
+            case Route::whisperTranslate: return "whisper-translate";
+            case Route::machineTranslate: return "machine-translate";
+        }
+        return "";
+    }
+
+    // UI label or code -> lower-case ISO code ("German" -> "de", "en-US" -> "en");
+    // "auto" for auto-detect
+    static std::string languageCode(const juce::String& nameOrCode)
+    {
+        static const std::pair<const char*, const char*> names[] = {
+            { "auto", "auto" }, { "english", "en" }, { "german", "de" }, { "swiss german", "gsw" },
+            { "french", "fr" }, { "italian", "it" }, { "spanish", "es" }, { "portuguese", "pt" },
+            { "dutch", "nl" },  { "polish", "pl" },  { "czech", "cs" },  { "japanese", "ja" }
+        };
+
+        const auto s = nameOrCode.trim().toLowerCase();
+        if (s.isEmpty())
+            return "auto";
+        for (const auto& [label, code] : names)
+            if (s == label)
+                return code;
+        return s.upToFirstOccurrenceOf("-", false, false).upToFirstOccurrenceOf("_", false, false).toStdString();
+    }
+
+    // The language whisper should be told: it has no Swiss German, which it hears as German
+    static std::string whisperLanguage(const std::string& code) { return code == "gsw" ? "de" : code; }
+
+    static bool sameLanguage(const std::string& a, const std::string& b) { return whisperLanguage(a) == whisperLanguage(b); }
+
+private:
+    std::atomic<bool> whisperTranslate { true };
+    std::array<std::atomic<uint64_t>, 3> counts {};
+    std::atomic<uint64_t> skippedChars { 0 };
+};
@@ -0,0 +1,174 @@
+#pragma once
+#include <algorithm>
+#include <chrono>
+#include <condition_variable>
+#include <cstddef>
+#include <cstdint>
+#include <deque>
+#include <functional>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+
+// One stage of the output pipeline: a bounded queue drained by its own
+// thread. Producers never wait on the stage's work, only (with the 'block'
+// policy) on queue space, so a slow network stage can't stall the decoder.
+//   block       producer waits for room (up to blockTimeoutMs, then drops)
+//   dropOldest  the stalest queued item makes room; right for live output
+//   dropNewest  the incoming item is discarded
+// A batch handler gets everything queued (up to maxBatch items) in one call,
+// for stages whose backend takes several items per round trip.
+enum class Backpressure { block, dropOldest, dropNewest };
+
+struct StageStats
+{
+    size_t depth = 0, capacity = 0;
+    float occupancy = 0.0f;     // smoothed fraction of time the stage is busy
+    uint64_t processed = 0, dropped = 0;
+};
+
+template <typename T>
+class StageWorker
+{
+public:
+    using Handler = std::function<void (T&)>;
+    using BatchHandler = std::function<void (std::vector<T>&)>;
+
+    StageWorker(std::string stageName, size_t capacity, Backpressure policy, Handler handler, int blockTimeoutMs = 200)
+        : StageWorker(std::move(stageName), capacity, policy, 1,
+                      [one = std::move(handler)](std::vector<T>& batch) { one(batch.front()); }, blockTimeoutMs)
+    {
+    }
+
+    StageWorker(std::string stageName, size_t capacity, Backpressure policy, size_t maxBatch, BatchHandler handler,
+                int blockTimeoutMs = 200)
+        : name(std::move(stageName)), cap(std::max<size_t>(1, capacity)), batchMax(std::max<size_t>(1, maxBatch)),
+          mode(policy), blockTimeout(blockTimeoutMs), fn(std::move(handler))
+    {
+        thread = std::thread(&StageWorker::run, this);
+    }
+
+    ~StageWorker()
+    {
+        {
+            std::lock_guard<std::mutex> lg(mx);
+            stopping = true;
+        }
+        itemCv.notify_all();
+        spaceCv.notify_all();
+        thread.join();
+    }
+
+    // Returns false if the item (or, with dropOldest, an older one) was dropped
+    bool push(T item)
+    {
+        std::unique_lock<std::mutex> lk(mx);
+        bool droppedAny = false;
+
+        if (items.size() >= cap)
+        {
+            switch (mode)
+            {
+                case Backpressure::block:
+                    if (spaceCv.wait_for(lk, std::chrono::milliseconds(blockTimeout),
+                                         [this] { return stopping || items.size() < cap; }) && ! stopping)
+                        break;
+                    ++dropped;
+                    return false;
+                case Backpressure::dropOldest:
+                    items.pop_front();
+                    ++dropped;
+                    droppedAny = true;
+                    break;
+                case Backpressure::dropNewest:
+                    ++dropped;
+                    return false;
+            }
+        }
+
+        items.push_back(std::move(item));
+        lk.unlock();
+        itemCv.notify_one();
+        return ! droppedAny;
+    }
+
+    // Discards everything queued (e.g. on reset); an item in flight finishes
+    void clear()
+    {
+        std::lock_guard<std::mutex> lg(mx);
+        items.clear();
+        spaceCv.notify_all();
+    }
+
+    StageStats getStats() const
+    {
+        std::lock_guard<std::mutex> lg(mx);
+        StageStats s;
+        s.depth = items.size();
+        s.capacity = cap;
+        s.occupancy = busyEma;
+        s.processed = processed;
+        s.dropped = dropped;
+        return s;
+    }
+
+    const std::string& getName() const { return name; }
+
+private:
+    using Clock = std::chrono::steady_clock;
+
+    void run()
+    {
+        std::unique_lock<std::mutex> lk(mx);
+        auto idleSince = Clock::now();
+        std::vector<T> batch;
+
+        for (;;)
+        {
+            itemCv.wait(lk, [this] { return stopping || ! items.empty(); });
+            if (stopping)
+                return;
+
+            batch.clear();
+            while (! items.empty() && batch.size() < batchMax)
+            {
+                batch.push_back(std::move(items.front()));
+                items.pop_front();
+            }
+            spaceCv.notify_all();
+            lk.unlock();
+
+            const auto start = Clock::now();
+            fn(batch);
+            const auto end = Clock::now();
+
+            // busy / (busy + idle) over each work cycle, smoothed
+            const double busy = std::chrono::duration<double>(end - start).count();
+            const double total = std::chrono::duration<double>(end - idleSince).count();
+            idleSince = end;
+
+            lk.lock();
+            processed += batch.size();
+            if (total > 0.0)
+                busyEma += 0.2f * ((float) (busy / total) - busyEma);
+        }
+    }
+
+    const std::string name;
+    const size_t cap;
+    const size_t batchMax;
+    const Backpressure mode;
+    const int blockTimeout;
+    BatchHandler fn;
+
+    mutable std::mutex mx;
+    std::condition_variable itemCv, spaceCv;
+    std::deque<T> items;
+    bool stopping = false;
+
+    float busyEma = 0.0f;
+    uint64_t processed = 0, dropped = 0;
+
+    std::thread thread;
+};
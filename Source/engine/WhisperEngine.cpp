@@ -8,31 +8,45 @@ extern "C" {
 #include "whisper.h"
 }
 
-static bool energyGate(const float* x, size_t n, float thr) {
-    double e = 0.0;
-    for (size_t i = 0; i < n; ++i) { double s = x[i]; e += s*s; }
-    e /= (double)std::max<size_t>(1, n);
-    return e > thr;
-}
-
-WhisperEngine::WhisperEngine(LockFreeRingBuffer& ring16k,
+WhisperEngine::WhisperEngine(AsrRing16k& ring16k,
                              MessageBus& b,
                              ITranslator& tr,
                              ITts& t,
                              const WhisperParams& p)
-: ring16k(ring16k), bus(b), translator(tr), tts(t), params(p)
+: ring16k(ring16k), bus(b), translator(tr), tts(t), params(p), output(tr, t, b)
 {
-    whisper_context_params wcp = whisper_context_default_params();
-    ctx = whisper_init_from_file_with_params(params.modelPath.c_str(), wcp);
-
     windowSamples = (size_t)(params.windowSec * 16000.0f);
     hopSamples    = (size_t)(params.hopSec    * 16000.0f);
-    window.resize(windowSamples, 0.0f);
+
+    // endpoint segments are read straight out of the history, so it has to
+    // hold the longest segment plus its pre-roll
+    size_t historySamples = windowSamples;
+    if (params.segmentation == Segmentation::endpoint)
+        historySamples = std::max(historySamples, (size_t)((params.maxSegmentSec + params.preRollSec) * 16000.0f) + 2 * StreamingVad::frameSize);
+    history = std::make_unique<SlidingWindow>(historySamples);
+
+    targetLang = RoutePlanner::languageCode(juce::String(params.dstLang));
+    realtime.setBudgetMs(params.decodeBudgetMs);
+
+    LanguageTracker::Config lc;
+    lc.recheckSec   = params.langRecheckSec;
+    lc.pauseSec     = params.langPauseSec;
+    lc.switchMargin = params.langSwitchMargin;
+    languageTracker.setConfig(lc);
+    realtime.setMaxBacklog((size_t)(params.maxBacklogSec * 16000.0f));
+    streamId = InferenceScheduler::instance().registerStream();
+
+    VadConfig vc;
+    vc.energyFloor  = params.vadEnergy;
+    vc.windowFrames = (int)(windowSamples / StreamingVad::frameSize);
+    vc.hangoverFrames = std::max(1, (int)(params.endpointSilenceSec * 16000.0f / StreamingVad::frameSize));
+    vad = std::make_unique<StreamingVad>(vc);
 }
 
 WhisperEngine::~WhisperEngine() { 
     stop();
-    if (ctx) whisper_free(ctx);
+    reset();
+    InferenceScheduler::instance().unregisterStream(streamId);
 }
 
 void WhisperEngine::start() {
@@ -42,199 +56,515 @@ void WhisperEngine::start() {
 
 void WhisperEngine::stop() {
     if (!running.exchange(false)) return;
+    ring16k.wakeReader();
     if (worker.joinable()) worker.join();
 }
 
+// Worker thread: load (or share) the weights, then warm up. Keeps plugin
+// construction and host scans from blocking on disk.
+bool WhisperEngine::acquireModel()
+{
+    // first run on this machine benchmarks the models in modelDir; later
+    // runs (and other instances) read the cached pick back
+    ModelCalibrator::Result pick;
+    if (! params.modelDir.empty()) {
+        modelState.store(ModelState::calibrating);
+        pick = ModelCalibrator::select(juce::File::getCurrentWorkingDirectory().getChildFile(juce::String(params.modelDir)),
+                                       params.targetRtf, [this](const juce::String& line) { log(line); },
+                                       [this] { return ! running.load(); });
+        if (! running.load()) {
+            modelState.store(ModelState::notLoaded); // stop() mid-benchmark; the next start() picks up from the cache
+            return false;
+        }
+        if (pick.isValid()) {
+            params.modelPath = pick.modelPath;
+            params.threads = pick.threads;
+        }
+    }
+
+    loadProgress.store(0.0f);
+    modelState.store(ModelState::loading);
+
+    // weights are shared process-wide; decoding state is ours alone
+    model = WhisperModelRegistry::acquire(params.modelPath, whisper_context_default_params(), &loadProgress);
+    ctx = model.get();
+    state = ctx ? whisper_init_state(ctx) : nullptr;
+    if (state == nullptr) {
+        model.reset();
+        ctx = nullptr;
+        modelState.store(ModelState::failed);
+        log("Whisper: failed to load " + juce::String(params.modelPath));
+        return false;
+    }
+
+    {
+        const juce::ScopedLock sl(selectionLock);
+        selection.modelPath = params.modelPath;
+        selection.threads = params.threads;
+        selection.rtf = pick.isValid() ? pick.rtf : 0.0;
+    }
+    log("ASR model: " + juce::File::getCurrentWorkingDirectory().getChildFile(juce::String(params.modelPath)).getFileName()
+        + ", " + (params.threads > 0 ? juce::String(params.threads) : juce::String("default")) + " threads"
+        + (pick.isValid() ? ", RTF " + juce::String(pick.rtf, 3) : juce::String()));
+
+    if (params.melCache && (! mel || mel->numMels() != whisper_model_n_mels(ctx)))
+        mel = std::make_unique<LogMelCache>(whisper_model_n_mels(ctx), history->capacity() / LogMelCache::hop + 2);
+
+    // one decode on silence allocates the compute graphs and pulls every
+    // weight page in, so the first real utterance doesn't pay for either
+    modelState.store(ModelState::warmingUp);
+    std::vector<float> silence(16000 + 1600, 0.0f);
+    InferenceScheduler::instance().run(streamId, juce::Time::getMillisecondCounterHiRes() + 2000.0, [&](int threads) {
+        whisper_full_params wparams = fullParams();
+        wparams.n_threads = jobThreads(threads);
+        whisper_full_with_state(ctx, state, wparams, silence.data(), (int)silence.size());
+    });
+
+    // whatever queued up while we were loading is stale by now
+    ring16k.consumeRead(ring16k.availableToRead());
+
+    ready.store(true);
+    modelState.store(ModelState::ready);
+    return true;
+}
+
 void WhisperEngine::threadFn() {
-    constexpr size_t frame = 320; // 20 ms @ 16k
-    std::vector<float> tmp(frame);
+    constexpr size_t frame = StreamingVad::frameSize; // 20 ms @ 16k
 
-    size_t filled = 0;
+    if (state == nullptr && ! acquireModel())
+        return; // stays 'failed' until loadModel() is given something else
+
+    const size_t parkAfter = (size_t)(params.idleParkSec * 16000.0f);
+    size_t silentRun = 0;
 
     while (running.load()) {
-        // pull 20ms when available (non-blocking)
-        size_t got = ring16k.pop(tmp.data(), frame);
-        if (got < frame) {
-            std::this_thread::sleep_for(std::chrono::milliseconds(2));
+        // sleep until the audio thread has a full 20ms frame for us (or stop() kicks us)
+        if (! ring16k.waitForData(frame, -1, [this] { return ! running.load(); }))
+            continue;
+
+        // hopelessly behind: drop the oldest queued audio instead of letting
+        // latency grow without bound
+        if (const size_t stale = realtime.staleSamples(ring16k.availableToRead())) {
+            ring16k.consumeRead(stale);
+            skipAudio(stale);
+            const auto st = realtime.getStats();
+            log("ASR behind: dropped " + juce::String(stale / 16000.0, 2) + " s (total "
+                + juce::String(st.droppedSamples / 16000.0, 1) + " s in " + juce::String((int)st.dropEvents)
+                + " drops), load " + juce::String(st.load, 2) + ", level " + juce::String(st.level));
             continue;
         }
 
-        // shift window left by 'frame', append new frame
-        if (filled + frame <= windowSamples) {
-            std::memcpy(window.data() + filled, tmp.data(), frame * sizeof(float));
-            filled += frame;
-        } else {
-            std::memmove(window.data(), window.data() + frame, (windowSamples - frame) * sizeof(float));
-            std::memcpy(window.data() + (windowSamples - frame), tmp.data(), frame * sizeof(float));
-            filled = windowSamples;
+        // copy the new frame straight out of the ring into the circular
+        // history; no sliding, the history hands out contiguous views
+        float* dst = history->writePointer();
+        auto region = ring16k.peekRead(frame);
+        convertSamples(region.data1, dst, region.frames1);
+        convertSamples(region.data2, dst + region.frames1, region.frames2);
+        ring16k.consumeRead(frame);
+        history->commit(frame);
+        samplesSeen += frame;
+        if (mel) mel->update(*history, samplesSeen);
+
+        // per-frame VAD, O(frame): features + onset/hangover + running window count
+        speechProb.store(vad->processFrame(dst), std::memory_order_relaxed);
+        languageTracker.onVadFrame(vad->isSpeech(), samplesSeen);
+
+        // park after a long stretch of silence: the audio thread then stops
+        // feeding us silent blocks and we sleep until something audible arrives
+        if (vad->frameEnergy() > params.vadEnergy) {
+            silentRun = 0;
+        } else if (parkAfter > 0 && (silentRun += frame) >= parkAfter && ! ring16k.isReaderParked()) {
+            ring16k.setReaderParked(true);
         }
 
-        // Only fire when we've accumulated at least hop size since last decode
-        static size_t sinceLast = 0;
-        sinceLast += frame;
-        if (sinceLast < hopSamples) continue;
-        sinceLast = 0;
+        if (params.segmentation == Segmentation::endpoint)
+            onEndpointFrame(frame);
+        else
+            onSlidingFrame(frame);
+    }
+}
 
-        if (filled < windowSamples) continue; // need full window initially
+// Stale audio was thrown away, so the timeline jumps ahead by 'samples'.
+// Whatever was tentative is committed as it stands; the history, mel frames,
+// VAD and segment start over after the gap, so no decode or token span
+// straddles it.
+void WhisperEngine::skipAudio(size_t samples)
+{
+    if (agreement.hasTentative())
+        publish(agreement.flush());
+
+    samplesSeen += samples;
+    lastDecodeAt = samplesSeen;
+    history->clear();
+    if (mel) mel->reset(samplesSeen);
+    vad->reset();
+    agreement.reset(samplesSeen);
+
+    inSegment = false;
+    sinceLast = sinceInterim = 0;
+    interimsDone = 0;
+}
 
-        // VAD-ish energy gate
-        if (!energyGate(window.data(), window.size(), params.vadEnergy)) continue;
+// Fixed window / hop: every hop, re-decode the uncommitted part of the window
+// while there's speech and commit what consecutive decodes agree on
+void WhisperEngine::onSlidingFrame(size_t frame)
+{
+    const int minSpeechFrames = std::max(1, (int)(params.vadMinSpeechSec * 16000.0f / frame));
 
-        // Run whisper on the 2s window
-        whisper_full_params wparams = whisper_full_default_params(WHISPER_SAMPLING_GREEDY);
-        wparams.print_realtime = false;
-        wparams.print_progress = false;
-        wparams.print_timestamps = false;
-        wparams.no_context = true;       // streaming friendliness
-        wparams.single_segment = true;   // one segment per call
-        wparams.translate = false;       // do not auto-translate here
-        wparams.language = "auto";       // autodetect
+    // Only fire when we've accumulated at least hop size since last decode
+    sinceLast += frame;
+    if (sinceLast < hopSamples * (size_t)realtime.hopScale()) return;
+    sinceLast = 0;
 
-        if (whisper_full(ctx, wparams, window.data(), (int)window.size()) != 0)
-            continue;
+    if (history->size() < windowSamples) return; // need full window initially
 
-        int n = whisper_full_n_segments(ctx);
-        if (n <= 0) continue;
-
-        // Take the last (most recent) segment
-        int si = n - 1;
-        const char* ctext = whisper_full_get_segment_text(ctx, si);
-        if (!ctext || !ctext[0]) continue;
-
-        TranscriptMsg tmsg;
-        tmsg.isFinal = true; // simple model: segment treated as final
-        tmsg.text = ctext;
-        bus.pushTranscript(tmsg);
-
-        // Translate (blocking, quick)
-        TranslateRequest tr;
-        tr.text = tmsg.text;
-        tr.srcLang = "auto";
-        tr.dstLang = params.dstLang;
-        std::string outText = translator.translate(tr);
-
-        // Kick TTS (asynchronous chunks pushed to bus)
-        TtsRequest req{ outText };
-        tts.synthesize(req, [this](const std::vector<float>& chunk, bool eof){
-            TtsPcmMsg m; m.pcm16k = chunk; m.eof = eof; bus.pushTts(m);
-        });
+    // no speech left in the window: the tentative tail is as good as it gets
+    if (! vad->isSpeech() && vad->speechFramesInWindow() < minSpeechFrames) {
+        if (agreement.hasTentative())
+            publish(agreement.flush());
+        agreement.reset(samplesSeen);
+        return;
     }
+
+    // uncommitted audio about to leave the window: commit its tail as is
+    const uint64_t windowStart = samplesSeen - windowSamples / (size_t)realtime.spanDivisor();
+    if (agreement.committedUpTo() < windowStart && agreement.hasTentative())
+        publish(agreement.flush());
+
+    const uint64_t start = std::max(agreement.committedUpTo(), windowStart);
+    if (decode(start, (size_t)(samplesSeen - start)))
+        publish(agreement.insert(hypothesis));
 }
 
-bool WhisperEngine::loadModel(const juce::File& path)
+// Endpointing: grow a segment while the VAD says speech, decode it once when
+// it ends at a pause (or hits the hard cap), with a few optional interims.
+// Interims commit the prefix they agree on; the final decode commits the rest.
+void WhisperEngine::onEndpointFrame(size_t frame)
 {
-    reset();
-    if (! path.existsAsFile()) return false;
+    const bool speech = vad->isSpeech();
+
+    if (! inSegment) {
+        if (! speech) return;
+
+        // speech onset: open a segment with a little pre-roll from the history
+        const size_t preRoll = std::min(history->size(), (size_t)(params.preRollSec * 16000.0f) + frame);
+        beginSegment(samplesSeen - preRoll);
+        return;
+    }
 
-    ctx = whisper_init_from_file(path.getFullPathName().toRawUTF8());
-    ready.store(ctx != nullptr);
-    return ready.load();
+    sinceInterim += frame;
+
+    const size_t segmentSamples = (size_t)(samplesSeen - segmentStart);
+    const size_t maxSegment = (size_t)(params.maxSegmentSec * 16000.0f) / (size_t)realtime.spanDivisor();
+    if (! speech || segmentSamples >= maxSegment) {
+        finalizeSegment();
+
+        // cut at the hard cap mid-speech: carry straight on with a new segment
+        if (speech)
+            beginSegment(samplesSeen);
+        return;
+    }
+
+    const size_t interimSamples = (size_t)(params.interimSec * 16000.0f);
+    if (interimSamples > 0 && sinceInterim >= interimSamples && interimsDone < params.maxInterimDecodes
+        && realtime.allowInterims()) {
+        sinceInterim = 0;
+        ++interimsDone;
+        const uint64_t start = agreement.committedUpTo();
+        if (decode(start, (size_t)(samplesSeen - start)))
+            publish(agreement.insert(hypothesis));
+    }
 }
 
-void WhisperEngine::reset()
+void WhisperEngine::beginSegment(uint64_t startSample)
 {
-    if (ctx)
-    {
-        whisper_free(ctx);
-        ctx = nullptr;
-    }
-    ready.store(false);
-    ring.setSize(1, 0);
-    ringWrite = 0;
+    segmentStart = startSample;
+    sinceInterim = 0;
+    interimsDone = 0;
+    inSegment = true;
+    agreement.reset(startSample);
 }
 
-void WhisperEngine::setLanguage(const juce::String& langCode)
+void WhisperEngine::finalizeSegment()
+{
+    inSegment = false;
+
+    const uint64_t start = std::max(agreement.committedUpTo(), samplesSeen - history->size());
+    const size_t remaining = (size_t)(samplesSeen - start);
+    const size_t minSpeech = (size_t)(params.vadMinSpeechSec * 16000.0f);
+
+    if (remaining >= minSpeech && decode(start, remaining))
+        publish(agreement.flush(hypothesis));
+    else
+        publish(agreement.flush());
+}
+
+whisper_full_params WhisperEngine::fullParams() const
 {
-    currentLang = langCode; // "auto" handled in transcribe
+    whisper_full_params wparams = whisper_full_default_params(WHISPER_SAMPLING_GREEDY);
+    wparams.print_realtime = false;
+    wparams.print_progress = false;
+    wparams.print_timestamps = false;
+    wparams.no_context = true;       // streaming friendliness
+    wparams.single_segment = true;   // one segment per call
+    wparams.token_timestamps = true; // commit policy compares token times
+    wparams.translate = false;       // decode() turns this on when it saves an MT call
+    wparams.language = "auto";       // autodetect
+    if (params.threads > 0)
+        wparams.n_threads = params.threads;
+    return wparams;
 }
 
-void WhisperEngine::ensureCapacity(int samples)
+// ggml threads for a scheduled decode: the calibrated count, capped at what
+// the scheduler grants each job so instances can't oversubscribe the cores
+int WhisperEngine::jobThreads(int granted) const
 {
-    if (ring.getNumSamples() < samples)
-        ring.setSize(1, samples, true, true, true);
+    return params.threads > 0 ? std::min(params.threads, granted) : granted;
 }
 
-void WhisperEngine::pushAudio(const float* interleaved, int frames, int numChannels, double sr)
+// Decodes the history span [startSample, startSample + numSamples) into
+// 'hypothesis' (text tokens with absolute sample timestamps)
+bool WhisperEngine::decode(uint64_t startSample, size_t numSamples)
 {
-    if (! ready.load() || frames <= 0) return;
+    hypothesis.clear();
 
-    // Downmix to mono, resample to 16k (cheap, acceptable for now)
-    const int monoSamples = frames;
-    downmixMono.setSize(1, monoSamples, false, false, true);
-    auto* mono = downmixMono.getWritePointer(0);
+    whisper_full_params wparams = fullParams();
 
-    if (numChannels == 1)
-        std::memcpy(mono, interleaved, sizeof(float) * monoSamples);
-    else
-    {
-        for (int i = 0; i < monoSamples; ++i)
-            mono[i] = 0.5f * (interleaved[2*i] + interleaved[2*i + 1]);
+    // language: fixed, or for "auto" the tracker's pinned language, with a
+    // detection pass only when the tracker asks for one
+    const auto langs = languages();
+    const bool autoLang = langs.first == "auto";
+    if (langs.first != trackedSource) {
+        languageTracker.reset();
+        trackedSource = langs.first;
+    }
+    const bool detect = autoLang && languageTracker.shouldDetect(samplesSeen);
+    decodeLang = autoLang ? languageTracker.language() : RoutePlanner::whisperLanguage(langs.first);
+
+    // task: with an English target a multilingual model translates in the
+    // same pass, and the utterance never needs MT
+    const bool multilingual = whisper_is_multilingual(ctx) != 0;
+    const auto chooseTask = [&] {
+        wparams.language = decodeLang.empty() ? "auto" : decodeLang.c_str();
+        wparams.translate = router.useWhisperTranslate(decodeLang.empty() ? langs.first : decodeLang, langs.second, multilingual);
+    };
+    chooseTask();
+
+    // over budget: size the encoder context to the audio instead of 30 s
+    if (realtime.fitAudioContext())
+        wparams.audio_ctx = std::min(1500, (int)(numSamples / 320) + 64);
+
+    // pad short utterances before queueing so the job only runs whisper
+    const float* pcm = nullptr;
+    size_t numPcm = numSamples;
+    if (mel) {
+        // features were computed as the audio arrived; hand whisper the
+        // cached frames (already padded to 30 s) and skip its own STFT
+        if (whisper_set_mel_with_state(ctx, state, mel->gather(startSample, numSamples), LogMelCache::maxFrames, mel->numMels()) != 0)
+            return false;
+    } else {
+        pcm = history->latest((size_t)(samplesSeen - startSample));
+
+        // whisper_full ignores anything under 1 s; pad short utterances with silence
+        constexpr size_t minDecode = 16000 + 1600;
+        if (numPcm < minDecode) {
+            padded.assign(minDecode, 0.0f);
+            std::memcpy(padded.data(), pcm, numPcm * sizeof(float));
+            pcm = padded.data();
+            numPcm = minDecode;
+        }
     }
 
-    // crude resample to 16k using JUCE Lagrange
-    static juce::LagrangeInterpolator resampler;
-    const double ratio = 16000.0 / std::max(1.0, sr);
-    const int target = (int) std::ceil(monoSamples * ratio) + 8;
-
-    juce::AudioBuffer<float> resOut(1, target);
-    const int done = resampler.process(ratio, mono, resOut.getWritePointer(0), monoSamples);
+    // runs on the shared scheduler, due before this decode would start
+    // eating into the next hop's budget
+    bool ok = false;
+    const double t0 = juce::Time::getMillisecondCounterHiRes();
+    InferenceScheduler::instance().run(streamId, t0 + realtime.getBudgetMs(), [&](int threads) {
+        wparams.n_threads = jobThreads(threads);
+        if (detect) {
+            detectLanguage(pcm, numPcm, wparams.n_threads);
+            chooseTask();
+        }
+        ok = whisper_full_with_state(ctx, state, wparams, pcm, pcm != nullptr ? (int)numPcm : 0) == 0;
+    });
+    if (! ok)
+        return false;
+
+    const int langId = whisper_full_lang_id_from_state(state);
+    spokenLang = langs.first != "auto" ? langs.first : langId >= 0 ? std::string(whisper_lang_str(langId)) : std::string();
+    whisperTranslated = wparams.translate;
+
+    // decode time (queueing behind other instances included) vs. the audio
+    // that arrived since the last one
+    const double decodeMs = juce::Time::getMillisecondCounterHiRes() - t0;
+    realtime.onDecode(decodeMs, (double)(samplesSeen - lastDecodeAt) / 16.0, (double)ring16k.availableToRead() / 16.0);
+    lastDecodeAt = samplesSeen;
+
+    // token times are in 10 ms units from the start of the span; padding can
+    // stretch the last one past the real audio, so clamp to the span
+    const auto toSample = [&](int64_t t) {
+        return startSample + (uint64_t)std::min<int64_t>((int64_t)numSamples, std::max<int64_t>(0, t) * 160);
+    };
+
+    const whisper_token eot = whisper_token_eot(ctx);
+    const int numSegments = whisper_full_n_segments_from_state(state);
+    double sumLogProb = 0.0;
+    for (int s = 0; s < numSegments; ++s) {
+        const int numTokens = whisper_full_n_tokens_from_state(state, s);
+        for (int i = 0; i < numTokens; ++i) {
+            const whisper_token_data data = whisper_full_get_token_data_from_state(state, s, i);
+            if (data.id >= eot) continue; // timestamps and other specials
+            sumLogProb += data.plog;
+
+            TimedToken tok;
+            tok.id = data.id;
+            tok.text = whisper_full_get_token_text_from_state(ctx, state, s, i);
+            tok.t0 = toSample(data.t0);
+            tok.t1 = std::max(tok.t0, toSample(data.t1));
+            hypothesis.push_back(std::move(tok));
+        }
+    }
 
-    const int n = done;
-    const juce::ScopedLock sl(ringLock);
-    ensureCapacity(ringWrite + n + 1);
-    auto* w = ring.getWritePointer(0);
-    std::memcpy(&w[ringWrite], resOut.getReadPointer(0), sizeof(float) * n);
-    ringWrite += n;
+    // a pinned language that no longer fits shows up as low token confidence
+    if (autoLang)
+        languageTracker.onDecoded(detect, ! hypothesis.empty(),
+                                  hypothesis.empty() ? 0.0f : (float)(sumLogProb / (double)hypothesis.size()));
+    return true;
 }
 
-void WhisperEngine::process(int maxMsPerTick)
+// Whisper's language-ID pass (encoder + one decoder step) over the audio
+// prepared for this decode; the tracker decides whether to move the pin.
+// Runs inside the scheduled job.
+void WhisperEngine::detectLanguage(const float* pcm, size_t numPcm, int threads)
 {
-    if (! ready.load()) return;
+    // on the mel path the features are already in the state
+    if (pcm != nullptr && whisper_pcm_to_mel_with_state(ctx, state, pcm, (int)numPcm, threads) != 0)
+        return;
 
-    int kChunk = 16000 * 1; // 1 second chunks at 16k
-    int localWrite;
-    {
-        const juce::ScopedLock sl(ringLock);
-        localWrite = ringWrite;
-        if (localWrite < kChunk) return;
-    }
+    langProbs.assign((size_t)whisper_lang_max_id() + 1, 0.0f);
+    const int best = whisper_lang_auto_detect_with_state(ctx, state, 0, threads, langProbs.data());
+    if (best < 0)
+        return;
+
+    const std::string previous = languageTracker.language();
+    const int pinnedId = previous.empty() ? -1 : whisper_lang_id(previous.c_str());
+    decodeLang = languageTracker.onDetection(whisper_lang_str(best), langProbs[(size_t)best],
+                                             pinnedId >= 0 ? langProbs[(size_t)pinnedId] : 0.0f, samplesSeen);
+    if (decodeLang != previous)
+        log("Language: " + juce::String(decodeLang) + " (p " + juce::String(langProbs[(size_t)best], 2) + ")");
+}
+
+void WhisperEngine::publish(const LocalAgreement::Update& u)
+{
+    // only newly committed text goes on to translation / TTS; the unstable
+    // tail is published for display only
+    if (! u.committed.empty())
+        emitTranscript(u.committed, true, u.committedStart, u.committedEnd);
+    if (! u.tentative.empty())
+        emitTranscript(u.tentative, false, agreement.committedUpTo(), samplesSeen);
+}
 
-    // copy out one chunk to avoid holding lock during inference
-    juce::HeapBlock<float> chunk(kChunk);
+void WhisperEngine::emitTranscript(const std::string& text, bool isFinal, uint64_t startSample, uint64_t endSample)
+{
+    TranscriptMsg tmsg;
+    tmsg.isFinal = isFinal;
+    tmsg.t0Sec = (double)startSample / 16000.0;
+    tmsg.t1Sec = (double)endSample   / 16000.0;
+    tmsg.text = text;
+    tmsg.lang = spokenLang;
+
+    const std::string dst = languages().second;
+    const Route route = router.plan(spokenLang, dst, whisperTranslated);
+    if (isFinal)
+        tmsg.route = RoutePlanner::name(route);
+    bus.pushTranscript(tmsg);
+
+    // partials are for display only
+    if (! isFinal) return;
+
+    if (onTranscript)
+        onTranscript(juce::String::fromUTF8(text.c_str()), juce::String(spokenLang));
+
+    router.record(route, text.size());
+
+    // translate + TTS run on their own stages; the next decode doesn't wait
+    bool queued = true;
+    switch (route)
     {
-        const juce::ScopedLock sl(ringLock);
-        std::memcpy(chunk.getData(), ring.getReadPointer(0), sizeof(float) * kChunk);
-        // shift remaining
-        auto* w = ring.getWritePointer(0);
-        std::memmove(w, &w[kChunk], sizeof(float) * (ringWrite - kChunk));
-        ringWrite -= kChunk;
+        case Route::passThrough:
+            return; // already in the target language: nothing to translate or say
+        case Route::whisperTranslate:
+        {
+            TtsRequest speech;
+            speech.text = text;
+            queued = output.speak(speech);
+            break;
+        }
+        case Route::machineTranslate:
+        {
+            TranslateRequest tr;
+            tr.text = text;
+            tr.srcLang = spokenLang.empty() ? "auto" : spokenLang;
+            tr.dstLang = dst;
+            queued = output.submit(tr);
+            break;
+        }
     }
+    if (! queued)
+        log("Output backlog: dropped the oldest pending utterance");
+}
 
-    transcribeChunk(chunk.getData(), kChunk);
+std::pair<std::string, std::string> WhisperEngine::languages() const
+{
+    const juce::SpinLock::ScopedLockType sl(langLock);
+    return { sourceLang, targetLang };
 }
 
-void WhisperEngine::transcribeChunk(const float* mono16k, int numSamples)
+// Loads asynchronously on the worker; asking for the model that is already
+// loaded (or loading) is a no-op, so callers don't pay for a second load.
+bool WhisperEngine::loadModel(const juce::File& path, int threads)
 {
-    whisper_full_params p = whisper_full_default_params(WHISPER_SAMPLING_GREEDY);
-    p.n_threads = std::max(1u, std::thread::hardware_concurrency()/2);
-    p.print_realtime = false;
-    p.print_progress = false;
-    p.single_segment = true;    // treat this chunk as one segment
-    p.no_timestamps  = true;
+    if (! path.existsAsFile()) return false;
 
-    if (currentLang != "auto")
-        p.language = currentLang.toRawUTF8();
-    else
-        p.language = nullptr; // auto-detect
+    const auto ms = getModelState();
+    const auto current = juce::File::getCurrentWorkingDirectory().getChildFile(juce::String(params.modelPath));
+    if (current == path && (threads <= 0 || threads == params.threads)
+        && ms != ModelState::failed && ms != ModelState::notLoaded && ms != ModelState::calibrating)
+        return true;
 
-    if (whisper_full(ctx, p, mono16k, numSamples) != 0)
-        return;
+    stop();
+    reset();
+    params.modelPath = path.getFullPathName().toStdString();
+    params.modelDir.clear();
+    if (threads > 0) params.threads = threads;
+    start();
+    return true;
+}
 
-    const int n = whisper_full_n_segments(ctx);
-    juce::String out;
-    for (int i = 0; i < n; ++i)
-        out += juce::String(whisper_full_get_segment_text(ctx, i));
+// Worker must be stopped
+void WhisperEngine::reset()
+{
+    if (state)
+    {
+        whisper_free_state(state);
+        state = nullptr;
+    }
+    model.reset(); // drops our reference to the shared weights
+    ctx = nullptr;
+    ready.store(false);
+    modelState.store(ModelState::notLoaded);
+}
 
-    if (onTranscript && out.isNotEmpty())
-        onTranscript(out.trim(), currentLang == "auto" ? "auto" : currentLang);
+void WhisperEngine::setLanguage(const juce::String& langCode)
+{
+    const auto code = RoutePlanner::languageCode(langCode);
+    const juce::SpinLock::ScopedLockType sl(langLock);
+    sourceLang = code;
+}
+
+void WhisperEngine::setTargetLanguage(const juce::String& langCode)
+{
+    const auto code = RoutePlanner::languageCode(langCode);
+    const juce::SpinLock::ScopedLockType sl(langLock);
+    targetLang = code;
 }
@@ -13,17 +13,52 @@
 #include "MessageBus.h"
 #include "../tts/ITts.h"
 #include "../translate/ITranslator.h"
-#include "../dsp/LockFreeRingBuffer.h"
+#include "../dsp/RingBuffer.h"
+#include "../dsp/StreamingVad.h"
+#include "../dsp/SlidingWindow.h"
+#include "../dsp/LogMelCache.h"
+#include "LocalAgreement.h"
+#include "WhisperModelRegistry.h"
+#include "ModelCalibrator.h"
+#include "RealtimeController.h"
+#include "InferenceScheduler.h"
+#include "OutputStages.h"
+#include "RoutePlanner.h"
+#include "LanguageTracker.h"
 #include "whisper.h"
 
 // forward decl from whisper.cpp headers
 struct whisper_context;
+struct whisper_state;
 struct whisper_full_params;
 struct WhisperParams {
+    enum class Segmentation {
+        slidingWindow, // decode a fixed window every hop
+        endpoint       // grow a segment while speech lasts, decode it once at the pause
+    };
+
     std::string modelPath;
-    float windowSec = 2.0f;
-    float hopSec    = 0.5f;
-    float vadEnergy = 1e-5f; // very light gate
+    std::string modelDir;     // if set, pick model + threads from here by on-device benchmark
+    float targetRtf = 0.5f;   // slowest acceptable real-time factor for that pick
+    int   threads   = 0;      // decoder threads (0 = whisper's default)
+    Segmentation segmentation = Segmentation::endpoint;
+    float windowSec = 2.0f;   // sliding: window length (endpoint: pre-roll history)
+    float hopSec    = 0.5f;   // sliding: decode period
+    float endpointSilenceSec = 0.4f; // endpoint: pause that closes a segment
+    float maxSegmentSec      = 12.0f;// endpoint: hard cap, cut and carry on
+    float preRollSec         = 0.3f; // endpoint: audio kept from before the onset
+    float interimSec         = 1.0f; // endpoint: interim re-decode period (0 = none)
+    int   maxInterimDecodes  = 2;    // endpoint: interims per segment
+    bool  melCache = true;    // decode from incrementally computed log-mel frames
+    float vadEnergy = 1e-5f; // very light gate (absolute floor for the VAD)
+    float vadMinSpeechSec = 0.2f; // speech needed in the window before we decode
+    int   decodeBudgetMs = 400;   // wall-clock budget per decode before we degrade
+    float maxBacklogSec  = 1.5f;  // queued audio beyond this is dropped, oldest first
+    float idleParkSec   = 3.0f;   // park the worker after this much silence (0 = never)
+    float parkWakeLevel = 0.003f; // input peak that wakes a parked worker (~ -50 dBFS)
+    float langRecheckSec   = 30.0f;  // auto language: re-detect at least this often
+    float langPauseSec     = 3.0f;   // auto language: re-detect when speech resumes after this
+    float langSwitchMargin = 0.2f;   // auto language: probability lead needed to switch
     std::string dstLang = "en";
 };
 
@@ -32,59 +67,135 @@ class WhisperEngine
 public:
     using OnTranscriptFn = std::function<void (const juce::String& text, const juce::String& lang)>;
 
-    WhisperEngine(LockFreeRingBuffer& ring16k,
+    WhisperEngine(AsrRing16k& ring16k,
                   MessageBus& bus,
                   ITranslator& translator,
                   ITts& tts,
                   const WhisperParams& p);
     ~WhisperEngine();
 
+    enum class ModelState { notLoaded, calibrating, loading, warmingUp, ready, failed };
+    using OnLogFn = std::function<void (const juce::String& line)>;
+
+    // start() also loads the model (on the worker) the first time round
     void start();
     void stop();
     bool isRunning() const { return running.load(); }
 
-    bool loadModel(const juce::File& modelPath);
-    void setLanguage(const juce::String& langCode); // "auto" allowed
-    void setCallback(OnTranscriptFn cb) { onTranscript = std::move(cb); }
+    ModelState getModelState() const { return modelState.load(); }
+    ModelCalibrator::Result getSelection() const { const juce::ScopedLock sl(selectionLock); return selection; }
+    float getLoadProgress() const    { return loadProgress.load(std::memory_order_relaxed); } // 0..1
 
-    // Feed interleaved stereo; we downmix to mono 16k
-    void pushAudio(const float* interleaved, int numFrames, int numChannels, double sampleRate);
+    // Explicit model choice (turns off auto-selection); threads 0 = keep current
+    bool loadModel(const juce::File& modelPath, int threads = 0);
+    void setLanguage(const juce::String& langCode); // "auto" allowed; UI labels are mapped to codes
+    void setTargetLanguage(const juce::String& langCode);
+    void setCallback(OnTranscriptFn cb) { onTranscript = std::move(cb); } // finals, on the worker; set before start()
+    void setLogCallback(OnLogFn cb)     { onLog = std::move(cb); } // called on the worker; set before start()
+    // Each translation as it comes back (translate thread); set before start()
+    void setOnTranslated(OutputStages::OnTranslatedFn fn) { output.setOnTranslated(std::move(fn)); }
 
-    // Called on worker thread periodically
-    void process(int maxMsPerTick = 50);
     MessageBus& getBus() { return bus; }
+    const WhisperParams& getParams() const { return params; }
+
+    // Per-decode budget for the real-time controller (any thread)
+    void setDecodeBudgetMs(int ms) { realtime.setBudgetMs(ms); }
+    RealtimeController::Stats getRealtimeStats() const { return realtime.getStats(); }
+    // Queue depth / occupancy of the translate and TTS stages
+    OutputStages::Stats getOutputStats() const { return output.getStats(); }
+    // How utterances were routed (pass-through / whisper translate / MT)
+    RoutePlanner::Stats getRouteStats() const { return router.getStats(); }
+    void setWhisperTranslate(bool enabled) { router.setWhisperTranslateEnabled(enabled); }
+    // Voice for everything this engine speaks (TtsRequest::voice / style)
+    void setVoice(const std::string& voice, const std::string& style) { output.setVoice(voice, style); }
+    // Detection passes vs. decodes that reused the pinned language ("auto" input)
+    LanguageTracker::Stats getLanguageStats() const { return languageTracker.getStats(); }
+
+    // Latest per-frame (20 ms) speech probability from the streaming VAD
+    float getSpeechProbability() const { return speechProb.load(std::memory_order_relaxed); }
 
     void reset();
 
 private:
-    void threadFn();
+    using Segmentation = WhisperParams::Segmentation;
 
-    LockFreeRingBuffer& ring16k;
+    void log(const juce::String& line) { if (onLog) onLog(line); }
+    bool acquireModel();
+    void threadFn();
+    whisper_full_params fullParams() const;
+    int jobThreads(int granted) const;
+    void onSlidingFrame(size_t frame);
+    void onEndpointFrame(size_t frame);
+    void beginSegment(uint64_t startSample);
+    void finalizeSegment();
+    bool decode(uint64_t startSample, size_t numSamples);
+    void detectLanguage(const float* pcm, size_t numPcm, int threads);
+    void publish(const LocalAgreement::Update& update);
+    void skipAudio(size_t samples);
+    void emitTranscript(const std::string& text, bool isFinal, uint64_t startSample, uint64_t endSample);
+    std::pair<std::string, std::string> languages() const; // source ("auto" allowed), target
+
+    AsrRing16k& ring16k;
     MessageBus& bus;
     ITranslator& translator;
     ITts& tts;
     WhisperParams params;
+    OutputStages output;                // translate + TTS for finals, own threads
+    RoutePlanner router;                // per-utterance skip of redundant stages
 
     std::atomic<bool> running{false};
     std::thread worker;
 
-    whisper_context* ctx = nullptr;
-    // sliding window buffer (16kHz)
-    std::vector<float> window;
+    std::atomic<ModelState> modelState { ModelState::notLoaded };
+    std::atomic<float> loadProgress { 0.0f };
+
+    WhisperModelRegistry::Model model;  // shared weights
+    whisper_context* ctx = nullptr;     // == model.get()
+    whisper_state* state = nullptr;     // this engine's decoder state / KV cache
+    // circular 16kHz history; sliding windows and endpoint segments are
+    // contiguous views of its newest samples (worker thread only)
+    std::unique_ptr<SlidingWindow> history;
     size_t windowSamples = 0;
     size_t hopSamples    = 0;
-
-    juce::AudioBuffer<float> downmixMono;   // 16k mono staging
-    juce::AudioBuffer<float> ring;          // 16k mono ring for chunking
-    int ringWrite = 0;
-    juce::CriticalSection ringLock;
-    juce::LagrangeInterpolator resampler;
-
-    juce::String currentLang = "auto";
+    size_t sinceLast     = 0;
+    uint64_t samplesSeen = 0;  // 16k samples consumed since start
+
+    // endpoint segmentation (worker thread only)
+    bool   inSegment     = false;
+    uint64_t segmentStart = 0;
+    size_t sinceInterim  = 0;
+    int    interimsDone  = 0;
+    std::vector<float> padded; // short-utterance padding for whisper_full (PCM path)
+    std::unique_ptr<LogMelCache> mel; // per-frame log-mel, shared by overlapping decodes
+
+    // streaming commit policy over consecutive decodes (worker thread only)
+    LocalAgreement agreement;
+    std::vector<TimedToken> hypothesis; // last decode's tokens
+
+    RealtimeController realtime;        // degrades / drops to keep latency bounded
+    int streamId = 0;                   // this engine's stream in the InferenceScheduler
+    uint64_t lastDecodeAt = 0;          // samplesSeen at the previous decode
+
+    std::unique_ptr<StreamingVad> vad;      // worker thread only
+    std::atomic<float> speechProb { 0.0f };
+
+    juce::SpinLock langLock;            // guards sourceLang / targetLang
+    std::string sourceLang = "auto", targetLang;
+
+    // last decode (worker thread only)
+    std::string decodeLang;             // language handed to whisper; must outlive the decode
+    std::string spokenLang;             // what whisper detected ("" if unknown)
+    bool whisperTranslated = false;     // the decode ran whisper's translate task
+
+    // "auto" input: detect at onset, then decode with the pinned language (worker thread only)
+    LanguageTracker languageTracker;
+    std::string trackedSource = "auto"; // source setting the tracker's pin belongs to
+    std::vector<float> langProbs;
     std::atomic<bool> ready { false };
 
     OnTranscriptFn onTranscript;
+    OnLogFn onLog;
 
-    void ensureCapacity(int samples);
-    void transcribeChunk(const float* mono, int numSamples);
+    juce::CriticalSection selectionLock;
+    ModelCalibrator::Result selection;  // model / threads / RTF in use
 };
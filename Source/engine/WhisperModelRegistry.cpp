@@ -0,0 +1,88 @@
+#include "WhisperModelRegistry.h"
+#include <algorithm>
+#include <cstring>
+
+#if JUCE_LINUX || JUCE_MAC || JUCE_BSD
+ #include <sys/mman.h>
+#endif
+
+juce::CriticalSection WhisperModelRegistry::lock;
+std::map<WhisperModelRegistry::Key, std::weak_ptr<whisper_context>> WhisperModelRegistry::models;
+
+WhisperModelRegistry::Model WhisperModelRegistry::acquire(const std::string& modelPath, const whisper_context_params& params,
+                                                          std::atomic<float>* progress)
+{
+    const juce::File file = juce::File::getCurrentWorkingDirectory().getChildFile(juce::String(modelPath));
+    const Key key { file.getFullPathName().toStdString(), params.use_gpu, params.flash_attn, params.gpu_device };
+
+    // held across the load so concurrent instances wait for one copy
+    // instead of loading their own
+    const juce::ScopedLock sl(lock);
+
+    if (auto existing = models[key].lock())
+    {
+        if (progress) progress->store(1.0f);
+        return existing;
+    }
+
+    whisper_context* ctx = load(file, params, progress);
+    if (ctx == nullptr)
+    {
+        models.erase(key);
+        return nullptr;
+    }
+
+    Model model(ctx, [key] (whisper_context* c)
+    {
+        whisper_free(c);
+
+        const juce::ScopedLock sl2(lock);
+        auto it = models.find(key);
+        if (it != models.end() && it->second.expired())
+            models.erase(it);
+    });
+    models[key] = model;
+    return model;
+}
+
+whisper_context* WhisperModelRegistry::load(const juce::File& file, const whisper_context_params& params, std::atomic<float>* progress)
+{
+    if (! file.existsAsFile())
+        return nullptr;
+
+    // Map the file read-only and let whisper read the weights straight out of
+    // the mapping rather than through its own buffered file reader; the
+    // mapping is released as soon as the tensors have been populated.
+    juce::MemoryMappedFile mapped(file, juce::MemoryMappedFile::readOnly);
+    if (mapped.getData() == nullptr)
+        return whisper_init_from_file_with_params_no_state(file.getFullPathName().toRawUTF8(), params);
+
+   #if JUCE_LINUX || JUCE_MAC || JUCE_BSD
+    // start paging the whole file in now instead of faulting it in tensor by tensor
+    madvise(mapped.getData(), mapped.getSize(), MADV_WILLNEED);
+   #endif
+
+    struct Reader
+    {
+        const char* data;
+        size_t size, pos;
+        std::atomic<float>* progress;
+    };
+    Reader reader { static_cast<const char*>(mapped.getData()), mapped.getSize(), 0, progress };
+
+    whisper_model_loader loader {};
+    loader.context = &reader;
+    loader.read = [] (void* ctx, void* output, size_t readSize) -> size_t
+    {
+        auto& r = *static_cast<Reader*>(ctx);
+        const size_t n = std::min(readSize, r.size - r.pos);
+        std::memcpy(output, r.data + r.pos, n);
+        r.pos += n;
+        if (r.progress) r.progress->store((float) r.pos / (float) r.size, std::memory_order_relaxed);
+        return n;
+    };
+    loader.eof   = [] (void* ctx) { auto& r = *static_cast<Reader*>(ctx); return r.pos >= r.size; };
+    loader.close = [] (void*) {};
+
+    return whisper_init_with_params_no_state(&loader, params);
+}
@@ -0,0 +1,42 @@
+#pragma once
+#include <atomic>
+#include <map>
+#include <memory>
+#include <string>
+#include <tuple>
+#include <juce_core/juce_core.h>
+#include "whisper.h"
+
+// Process-wide, reference-counted cache of loaded whisper models.
+// Every plugin instance asking for the same file with the same context
+// parameters shares one whisper_context (the weights, loaded without state);
+// each engine then creates its own whisper_state for decoding. The weights
+// are freed when the last instance lets go of them.
+class WhisperModelRegistry
+{
+public:
+    using Model = std::shared_ptr<whisper_context>;
+
+    // Returns the shared model, loading it on first use; nullptr on failure.
+    // progress (optional) is moved from 0 to 1 as the weights are read.
+    static Model acquire(const std::string& modelPath, const whisper_context_params& params,
+                         std::atomic<float>* progress = nullptr);
+
+private:
+    struct Key
+    {
+        std::string path;
+        bool useGpu = false, flashAttn = false;
+        int gpuDevice = 0;
+
+        bool operator< (const Key& o) const
+        {
+            return std::tie(path, useGpu, flashAttn, gpuDevice) < std::tie(o.path, o.useGpu, o.flashAttn, o.gpuDevice);
+        }
+    };
+
+    static whisper_context* load(const juce::File& file, const whisper_context_params& params, std::atomic<float>* progress);
+
+    static juce::CriticalSection lock;
+    static std::map<Key, std::weak_ptr<whisper_context>> models;
+};
@@ -0,0 +1,66 @@
+#pragma once
+#include <mutex>
+#include <juce_core/juce_core.h>
+
+// Classic three-state breaker for a network backend.
+//   closed     calls go through; failureThreshold consecutive failures trip it
+//   open       calls are skipped until coolDownMs has passed
+//   halfOpen   one trial call is let through; success closes, failure re-opens
+class CircuitBreaker
+{
+public:
+    enum class State { closed, open, halfOpen };
+
+    CircuitBreaker(int failureThreshold = 3, double coolDownMs = 10000.0)
+        : threshold(failureThreshold), coolDown(coolDownMs) {}
+
+    // false = skip the backend and degrade straight away
+    bool allow()
+    {
+        std::lock_guard<std::mutex> lg(mx);
+        if (state == State::open && juce::Time::getMillisecondCounterHiRes() - openedAt >= coolDown)
+        {
+            state = State::halfOpen;
+            trialInFlight = false;
+        }
+
+        switch (state)
+        {
+            case State::closed:   return true;
+            case State::open:     return false;
+            case State::halfOpen: if (trialInFlight) return false; trialInFlight = true; return true;
+        }
+        return true;
+    }
+
+    void onSuccess()
+    {
+        std::lock_guard<std::mutex> lg(mx);
+        failures = 0;
+        state = State::closed;
+    }
+
+    void onFailure()
+    {
+        std::lock_guard<std::mutex> lg(mx);
+        if (state == State::halfOpen || ++failures >= threshold)
+        {
+            state = State::open;
+            openedAt = juce::Time::getMillisecondCounterHiRes();
+            ++trips;
+        }
+    }
+
+    State getState() const { std::lock_guard<std::mutex> lg(mx); return state; }
+    int getTrips() const   { std::lock_guard<std::mutex> lg(mx); return trips; }
+
+private:
+    const int threshold;
+    const double coolDown;
+
+    mutable std::mutex mx;
+    State state = State::closed;
+    int failures = 0, trips = 0;
+    double openedAt = 0.0;
+    bool trialInFlight = false;
+};
@@ -0,0 +1,514 @@
+#include "HttpClient.h"
+#include <map>
+#include <mutex>
+#include <vector>
+
+#if JUCE_WINDOWS
+ #ifndef NOMINMAX
+  #define NOMINMAX
+ #endif
+ #include <windows.h>
+ #include <winhttp.h>
+ #if JUCE_MSVC
+  #pragma comment (lib, "winhttp.lib")
+ #endif
+#elif JUCE_LINUX && JUCE_USE_CURL
+ #include <curl/curl.h>
+#endif
+
+namespace
+{
+    struct UrlParts
+    {
+        bool secure = true;
+        juce::String host, path;  // path includes the query
+        int port = 0;
+    };
+
+    UrlParts splitUrl(const juce::String& url)
+    {
+        UrlParts p;
+        p.secure = ! url.startsWithIgnoreCase("http://");
+        const auto rest = url.fromFirstOccurrenceOf("://", false, false);
+        const auto hostPort = rest.upToFirstOccurrenceOf("/", false, false);
+        p.path = rest.substring(hostPort.length());
+        if (p.path.isEmpty()) p.path = "/";
+        p.host = hostPort.upToFirstOccurrenceOf(":", false, false);
+        p.port = hostPort.containsChar(':') ? hostPort.fromFirstOccurrenceOf(":", false, false).getIntValue()
+                                            : (p.secure ? 443 : 80);
+        return p;
+    }
+
+    juce::String originOf(const juce::String& url)
+    {
+        const auto p = splitUrl(url);
+        return juce::String(p.secure ? "https://" : "http://") + p.host + ":" + juce::String(p.port) + "/";
+    }
+
+    double nowMs() { return juce::Time::getMillisecondCounterHiRes(); }
+
+    // The status line arrived but the body didn't, all of it: report it as
+    // no response, so callers (and their breakers / caches) see a failure
+    [[maybe_unused]] void truncated(HttpResponse& r, const juce::String& why)
+    {
+        r.status = 0;
+        r.error = why;
+    }
+}
+
+//==============================================================================
+#if JUCE_WINDOWS
+
+// One WinHTTP session for the process; WinHTTP keeps idle keep-alive
+// connections per host inside it. Connection phases are timed from the
+// status callback, which WinHTTP also fires for synchronous requests.
+struct HttpClient::Backend
+{
+    struct Phases
+    {
+        double resolving = -1, resolved = -1, connecting = -1, connected = -1, sending = -1;
+    };
+
+    Backend()
+    {
+        session = WinHttpOpen(L"LiveTranslator/1.0", WINHTTP_ACCESS_TYPE_DEFAULT_PROXY,
+                              WINHTTP_NO_PROXY_NAME, WINHTTP_NO_PROXY_BYPASS, 0);
+        if (session != nullptr)
+            WinHttpSetStatusCallback(session, &statusCallback,
+                                     WINHTTP_CALLBACK_FLAG_RESOLVE_NAME | WINHTTP_CALLBACK_FLAG_CONNECT_TO_SERVER
+                                       | WINHTTP_CALLBACK_FLAG_SEND_REQUEST, 0);
+    }
+
+    ~Backend()
+    {
+        for (auto& c : connections) WinHttpCloseHandle(c.second);
+        if (session != nullptr) WinHttpCloseHandle(session);
+    }
+
+    static void CALLBACK statusCallback(HINTERNET, DWORD_PTR context, DWORD status, LPVOID, DWORD)
+    {
+        auto* ph = reinterpret_cast<Phases*>(context);
+        if (ph == nullptr) return;
+
+        switch (status)
+        {
+            case WINHTTP_CALLBACK_STATUS_RESOLVING_NAME:      ph->resolving  = nowMs(); break;
+            case WINHTTP_CALLBACK_STATUS_NAME_RESOLVED:       ph->resolved   = nowMs(); break;
+            case WINHTTP_CALLBACK_STATUS_CONNECTING_TO_SERVER: ph->connecting = nowMs(); break;
+            case WINHTTP_CALLBACK_STATUS_CONNECTED_TO_SERVER: ph->connected  = nowMs(); break;
+            case WINHTTP_CALLBACK_STATUS_SENDING_REQUEST:     if (ph->sending < 0) ph->sending = nowMs(); break;
+            default: break;
+        }
+    }
+
+    HINTERNET connectionFor(const UrlParts& p)
+    {
+        const auto key = p.host + ":" + juce::String(p.port);
+        std::lock_guard<std::mutex> lg(mx);
+        auto& c = connections[key];
+        if (c == nullptr)
+            c = WinHttpConnect(session, p.host.toWideCharPointer(), (INTERNET_PORT) p.port, 0);
+        return c;
+    }
+
+    HttpResponse send(const HttpRequest& request, const OnData& onData)
+    {
+        HttpResponse r;
+        const double t0 = nowMs();
+        const auto parts = splitUrl(request.url);
+
+        HINTERNET conn = session != nullptr ? connectionFor(parts) : nullptr;
+        if (conn == nullptr)
+        {
+            r.error = "WinHTTP session unavailable";
+            return r;
+        }
+
+        HINTERNET req = WinHttpOpenRequest(conn, request.method.toWideCharPointer(), parts.path.toWideCharPointer(),
+                                           nullptr, WINHTTP_NO_REFERER, WINHTTP_DEFAULT_ACCEPT_TYPES,
+                                           parts.secure ? WINHTTP_FLAG_SECURE : 0);
+        if (req == nullptr)
+        {
+            r.error = "WinHttpOpenRequest failed";
+            return r;
+        }
+
+        Phases phases;
+        DWORD_PTR ctx = reinterpret_cast<DWORD_PTR>(&phases);
+        WinHttpSetOption(req, WINHTTP_OPTION_CONTEXT_VALUE, &ctx, sizeof(ctx));
+        WinHttpSetTimeouts(req, request.timeoutMs, request.timeoutMs, request.timeoutMs, request.timeoutMs);
+
+        juce::String headers;
+        for (auto& k : request.headers.getAllKeys())
+            headers << k << ": " << request.headers[k] << "\r\n";
+
+        auto* body = const_cast<void*>(request.body.getData());
+        const auto bodySize = (DWORD) request.body.getSize();
+
+        const bool sent = WinHttpSendRequest(req, headers.isEmpty() ? WINHTTP_NO_ADDITIONAL_HEADERS : headers.toWideCharPointer(),
+                                             headers.isEmpty() ? 0 : (DWORD) -1L,
+                                             bodySize > 0 ? body : WINHTTP_NO_REQUEST_DATA, bodySize, bodySize, 0)
+                       && WinHttpReceiveResponse(req, nullptr);
+        if (sent)
+        {
+            r.timings.firstByteMs = nowMs() - t0;
+
+            DWORD code = 0, size = sizeof(code);
+            WinHttpQueryHeaders(req, WINHTTP_QUERY_STATUS_CODE | WINHTTP_QUERY_FLAG_NUMBER,
+                                WINHTTP_HEADER_NAME_BY_INDEX, &code, &size, WINHTTP_NO_HEADER_INDEX);
+            r.status = (int) code;
+
+            ULONGLONG expected = 0;
+            DWORD lengthSize = sizeof(expected);
+            const bool haveLength = request.method != "HEAD"
+                && WinHttpQueryHeaders(req, WINHTTP_QUERY_CONTENT_LENGTH | WINHTTP_QUERY_FLAG_NUMBER64,
+                                       WINHTTP_HEADER_NAME_BY_INDEX, &expected, &lengthSize, WINHTTP_NO_HEADER_INDEX);
+
+            char buffer[16384];
+            DWORD got = 0;
+            ULONGLONG received = 0;
+            bool aborted = false, readFailed = false;
+            for (;;)
+            {
+                if (! WinHttpReadData(req, buffer, sizeof(buffer), &got))
+                {
+                    readFailed = true;
+                    break;
+                }
+                if (got == 0)
+                    break;
+                received += got;
+                if (onData) { if (! onData(buffer, got)) { aborted = true; break; } }
+                else        r.body.append(buffer, got);
+            }
+
+            // a body that broke off is no response, whatever the status line said
+            if (readFailed)
+                truncated(r, "WinHTTP read error " + juce::String((int) GetLastError()));
+            else if (! aborted && haveLength && received < expected)
+                truncated(r, "body cut off after " + juce::String((juce::int64) received) + " of "
+                               + juce::String((juce::int64) expected) + " bytes");
+        }
+        else
+        {
+            r.error = "WinHTTP error " + juce::String((int) GetLastError());
+        }
+
+        ctx = 0; // phases is about to go out of scope
+        WinHttpSetOption(req, WINHTTP_OPTION_CONTEXT_VALUE, &ctx, sizeof(ctx));
+        WinHttpCloseHandle(req);
+
+        r.timings.totalMs = nowMs() - t0;
+        r.timings.reusedConnection = phases.connecting < 0;
+        if (phases.resolved >= 0 && phases.resolving >= 0) r.timings.dnsMs = phases.resolved - phases.resolving;
+        if (phases.connected >= 0 && phases.connecting >= 0) r.timings.connectMs = phases.connected - phases.connecting;
+        if (parts.secure && phases.sending >= 0 && phases.connected >= 0) r.timings.tlsMs = phases.sending - phases.connected;
+        return r;
+    }
+
+    HINTERNET session = nullptr;
+    std::mutex mx;
+    std::map<juce::String, HINTERNET> connections;
+};
+
+//==============================================================================
+#elif JUCE_LINUX && JUCE_USE_CURL
+
+// Easy handles are pooled and all of them share one connection, DNS and TLS
+// session cache, so any handle can pick up a live connection to the host.
+struct HttpClient::Backend
+{
+    Backend()
+    {
+        curl_global_init(CURL_GLOBAL_DEFAULT);
+        share = curl_share_init();
+        curl_share_setopt(share, CURLSHOPT_SHARE, CURL_LOCK_DATA_CONNECT);
+        curl_share_setopt(share, CURLSHOPT_SHARE, CURL_LOCK_DATA_DNS);
+        curl_share_setopt(share, CURLSHOPT_SHARE, CURL_LOCK_DATA_SSL_SESSION);
+        curl_share_setopt(share, CURLSHOPT_LOCKFUNC, &lockShare);
+        curl_share_setopt(share, CURLSHOPT_UNLOCKFUNC, &unlockShare);
+        curl_share_setopt(share, CURLSHOPT_USERDATA, this);
+    }
+
+    ~Backend()
+    {
+        for (auto* h : idle) curl_easy_cleanup(h);
+        curl_share_cleanup(share);
+    }
+
+    static void lockShare(CURL*, curl_lock_data data, curl_lock_access, void* user)
+    {
+        static_cast<Backend*>(user)->shareLocks[(size_t) data % numLocks].lock();
+    }
+
+    static void unlockShare(CURL*, curl_lock_data data, void* user)
+    {
+        static_cast<Backend*>(user)->shareLocks[(size_t) data % numLocks].unlock();
+    }
+
+    struct Sink
+    {
+        const OnData* onData;
+        juce::MemoryBlock* body;
+    };
+
+    static size_t write(char* data, size_t size, size_t count, void* user)
+    {
+        auto& sink = *static_cast<Sink*>(user);
+        const size_t n = size * count;
+        if (*sink.onData)
+            return (*sink.onData)(data, n) ? n : 0; // 0 aborts the transfer
+        sink.body->append(data, n);
+        return n;
+    }
+
+    HttpResponse send(const HttpRequest& request, const OnData& onData)
+    {
+        HttpResponse r;
+        CURL* h = acquire();
+        if (h == nullptr)
+        {
+            r.error = "curl unavailable";
+            return r;
+        }
+
+        curl_slist* headers = nullptr;
+        for (auto& k : request.headers.getAllKeys())
+            headers = curl_slist_append(headers, (k + ": " + request.headers[k]).toRawUTF8());
+
+        Sink sink { &onData, &r.body };
+        curl_easy_setopt(h, CURLOPT_SHARE, share);
+        curl_easy_setopt(h, CURLOPT_URL, request.url.toRawUTF8());
+        curl_easy_setopt(h, CURLOPT_HTTPHEADER, headers);
+        curl_easy_setopt(h, CURLOPT_NOSIGNAL, 1L);
+        curl_easy_setopt(h, CURLOPT_TCP_KEEPALIVE, 1L);
+        curl_easy_setopt(h, CURLOPT_TIMEOUT_MS, (long) request.timeoutMs);
+        curl_easy_setopt(h, CURLOPT_WRITEFUNCTION, &write);
+        curl_easy_setopt(h, CURLOPT_WRITEDATA, &sink);
+
+        if (request.method == "POST")
+        {
+            curl_easy_setopt(h, CURLOPT_POST, 1L);
+            curl_easy_setopt(h, CURLOPT_POSTFIELDS, request.body.getData());
+            curl_easy_setopt(h, CURLOPT_POSTFIELDSIZE_LARGE, (curl_off_t) request.body.getSize());
+        }
+        else if (request.method == "HEAD")
+        {
+            curl_easy_setopt(h, CURLOPT_NOBODY, 1L);
+        }
+        else if (request.method != "GET")
+        {
+            curl_easy_setopt(h, CURLOPT_CUSTOMREQUEST, request.method.toRawUTF8());
+        }
+
+        const CURLcode rc = curl_easy_perform(h);
+        if (rc == CURLE_OK || rc == CURLE_WRITE_ERROR)
+        {
+            long code = 0;
+            curl_easy_getinfo(h, CURLINFO_RESPONSE_CODE, &code);
+            r.status = (int) code;
+        }
+        if (rc != CURLE_OK)
+            r.error = curl_easy_strerror(rc);
+
+        // curl's phase times are cumulative from the start of the request
+        curl_off_t dns = 0, connect = 0, tls = 0, first = 0, total = 0;
+        long newConnections = 0;
+        curl_easy_getinfo(h, CURLINFO_NAMELOOKUP_TIME_T, &dns);
+        curl_easy_getinfo(h, CURLINFO_CONNECT_TIME_T, &connect);
+        curl_easy_getinfo(h, CURLINFO_APPCONNECT_TIME_T, &tls);
+        curl_easy_getinfo(h, CURLINFO_STARTTRANSFER_TIME_T, &first);
+        curl_easy_getinfo(h, CURLINFO_TOTAL_TIME_T, &total);
+        curl_easy_getinfo(h, CURLINFO_NUM_CONNECTS, &newConnections);
+
+        r.timings.reusedConnection = newConnections == 0;
+        if (! r.timings.reusedConnection)
+        {
+            r.timings.dnsMs = (double) dns / 1000.0;
+            r.timings.connectMs = (double) (connect - dns) / 1000.0;
+            if (tls > 0) r.timings.tlsMs = (double) (tls - connect) / 1000.0;
+        }
+        if (first > 0) r.timings.firstByteMs = (double) first / 1000.0;
+        r.timings.totalMs = (double) total / 1000.0;
+
+        curl_slist_free_all(headers);
+        release(h);
+        return r;
+    }
+
+    CURL* acquire()
+    {
+        {
+            std::lock_guard<std::mutex> lg(mx);
+            if (! idle.empty())
+            {
+                CURL* h = idle.back();
+                idle.pop_back();
+                return h;
+            }
+        }
+        return curl_easy_init();
+    }
+
+    void release(CURL* h)
+    {
+        curl_easy_reset(h);
+        std::lock_guard<std::mutex> lg(mx);
+        idle.push_back(h);
+    }
+
+    static constexpr size_t numLocks = 8;
+    CURLSH* share = nullptr;
+    std::mutex shareLocks[numLocks];
+    std::mutex mx;
+    std::vector<CURL*> idle;
+};
+
+//==============================================================================
+#else
+
+// Falls back to JUCE's stream, which on macOS sits on NSURLSession and so
+// still reuses connections; only first-byte and total time are measured.
+struct HttpClient::Backend
+{
+    HttpResponse send(const HttpRequest& request, const OnData& onData)
+    {
+        HttpResponse r;
+        const double t0 = nowMs();
+
+        juce::URL url(request.url);
+        const bool post = request.method == "POST";
+        if (post && request.body.getSize() > 0)
+            url = url.withPOSTData(request.body);
+
+        juce::String headers;
+        for (auto& k : request.headers.getAllKeys())
+            headers << k << ": " << request.headers[k] << "\r\n";
+
+        juce::WebInputStream stream(url, post);
+        stream.withExtraHeaders(headers).withConnectionTimeout(request.timeoutMs);
+        if (! post && request.method != "GET")
+            stream.withCustomRequestCommand(request.method);
+
+        if (! stream.connect(nullptr))
+        {
+            r.error = "connect failed";
+            r.timings.totalMs = nowMs() - t0;
+            return r;
+        }
+        r.timings.firstByteMs = nowMs() - t0;
+        r.status = stream.getStatusCode();
+
+        char buffer[16384];
+        juce::int64 received = 0;
+        bool aborted = false;
+        for (;;)
+        {
+            const int got = stream.read(buffer, (int) sizeof(buffer));
+            if (got <= 0) break;
+            received += got;
+            if (onData) { if (! onData(buffer, (size_t) got)) { aborted = true; break; } }
+            else        r.body.append(buffer, (size_t) got);
+        }
+
+        // a body that broke off is no response, whatever the status line said
+        const juce::int64 expected = stream.getTotalLength(); // -1 when the server didn't say
+        if (! aborted && request.method != "HEAD")
+        {
+            if (stream.isError())
+                truncated(r, "read error");
+            else if (expected >= 0 && received < expected)
+                truncated(r, "body cut off after " + juce::String(received) + " of " + juce::String(expected) + " bytes");
+        }
+
+        r.timings.totalMs = nowMs() - t0;
+        return r;
+    }
+};
+
+#endif
+
+//==============================================================================
+namespace
+{
+std::mutex sharedLock;
+int sharedUsers = 0;
+HttpClient* sharedClient = nullptr;
+}
+
+HttpClient::Lifetime::Lifetime()
+{
+    std::lock_guard<std::mutex> lg(sharedLock);
+    if (sharedUsers++ == 0)
+        sharedClient = new HttpClient();
+}
+
+HttpClient::Lifetime::~Lifetime()
+{
+    HttpClient* last = nullptr;
+    {
+        std::lock_guard<std::mutex> lg(sharedLock);
+        if (--sharedUsers == 0)
+            std::swap(last, sharedClient);
+    }
+    delete last; // outside the lock: waits for a prewarm in flight
+}
+
+HttpClient& HttpClient::shared()
+{
+    std::lock_guard<std::mutex> lg(sharedLock);
+    jassert (sharedClient != nullptr); // no HttpClient::Lifetime held
+    return *sharedClient;
+}
+
+HttpClient::HttpClient() : backend(std::make_unique<Backend>()) {}
+
+HttpClient::~HttpClient()
+{
+    prewarmPool.removeAllJobs(true, 5000);
+}
+
+HttpResponse HttpClient::send(const HttpRequest& request, OnData onData)
+{
+    auto r = backend->send(request, onData);
+    record(r);
+    return r;
+}
+
+void HttpClient::prewarm(const juce::String& url)
+{
+    const auto origin = originOf(url);
+    {
+        // one handshake per host per keep-alive period is enough
+        const juce::ScopedLock sl(statsLock);
+        const double now = nowMs();
+        auto& last = lastPrewarm[origin];
+        if (last > 0.0 && now - last < prewarmIntervalMs)
+            return;
+        last = now;
+    }
+
+    prewarmPool.addJob([this, origin]
+    {
+        HttpRequest r;
+        r.method = "HEAD";
+        r.url = origin;
+        r.timeoutMs = 5000;
+        send(r);
+    });
+}
+
+HttpClient::Stats HttpClient::getStats() const
+{
+    const juce::ScopedLock sl(statsLock);
+    return stats;
+}
+
+void HttpClient::record(const HttpResponse& r)
+{
+    const juce::ScopedLock sl(statsLock);
+    ++stats.requests;
+    if (! r.timings.reusedConnection) ++stats.newConnections;
+    if (r.status == 0)                ++stats.failures;
+    stats.last = r.timings;
+}
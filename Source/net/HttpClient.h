@@ -0,0 +1,95 @@
+#pragma once
+#include <atomic>
+#include <functional>
+#include <map>
+#include <memory>
+#include <juce_core/juce_core.h>
+
+// Where the time of one request went. -1 = not measured on this platform or
+// not applicable (dns / connect / tls stay -1 on a reused connection).
+struct HttpTimings
+{
+    double dnsMs = -1.0, connectMs = -1.0, tlsMs = -1.0;
+    double firstByteMs = -1.0, totalMs = 0.0;
+    bool reusedConnection = false;
+};
+
+struct HttpRequest
+{
+    juce::String method { "POST" };
+    juce::String url;
+    juce::StringPairArray headers;
+    juce::MemoryBlock body;
+    int timeoutMs = 10000;
+};
+
+struct HttpResponse
+{
+    int status = 0;          // 0 = no response (connect / timeout / abort / body cut short)
+    juce::MemoryBlock body;  // empty when the caller streamed it
+    HttpTimings timings;
+    juce::String error;
+
+    bool ok() const { return status >= 200 && status < 300; }
+};
+
+// Process-wide HTTP/1.1 client shared by the translator and TTS backends.
+// Connections are kept alive and pooled per host, so a request to a host we
+// have talked to recently skips DNS, TCP and TLS setup.
+//   Windows   WinHTTP session (pools per host; timings from status callbacks)
+//   Linux     libcurl with a shared connection / DNS cache (JUCE_USE_CURL)
+//   elsewhere juce::WebInputStream (NSURLSession pools on macOS)
+class HttpClient
+{
+public:
+    // Called with each piece of the body as it arrives; return false to abort
+    using OnData = std::function<bool (const void* data, size_t size)>;
+
+    struct Stats
+    {
+        uint64_t requests = 0, newConnections = 0, failures = 0;
+        HttpTimings last;
+    };
+
+    // Keeps the shared client alive. Each plugin instance holds one for as
+    // long as anything it owns can make a request; the last one to go
+    // drains the prewarm pool and closes the pooled connections there and
+    // then, instead of in a static destructor while the binary is unloaded.
+    class Lifetime
+    {
+    public:
+        Lifetime();
+        ~Lifetime();
+        JUCE_DECLARE_NON_COPYABLE(Lifetime)
+    };
+
+    // Only while a Lifetime exists
+    static HttpClient& shared();
+    ~HttpClient();
+
+    // Blocking. With onData the body is handed over as it arrives instead
+    // of being collected into the response.
+    HttpResponse send(const HttpRequest& request, OnData onData = nullptr);
+
+    // Opens (and pools) a connection to the url's host in the background,
+    // so the first real request doesn't pay for the handshake
+    void prewarm(const juce::String& url);
+
+    Stats getStats() const;
+
+private:
+    HttpClient();
+
+    struct Backend;
+    std::unique_ptr<Backend> backend;
+
+    void record(const HttpResponse& r);
+
+    static constexpr double prewarmIntervalMs = 30000.0;
+
+    mutable juce::CriticalSection statsLock;
+    Stats stats;
+    std::map<juce::String, double> lastPrewarm; // origin -> last prewarm (statsLock)
+
+    juce::ThreadPool prewarmPool { 1 };
+};
@@ -0,0 +1,46 @@
+#pragma once
+#include <algorithm>
+#include <array>
+#include <mutex>
+
+// Rolling window of the most recent call latencies, for tail percentiles
+// (the hedging trigger). Too few samples -> no estimate.
+class LatencyTracker
+{
+public:
+    static constexpr size_t window = 64;
+    static constexpr size_t minSamples = 16;
+
+    void add(double ms)
+    {
+        std::lock_guard<std::mutex> lg(mx);
+        samples[next] = ms;
+        next = (next + 1) % window;
+        count = std::min(count + 1, window);
+    }
+
+    // q in [0, 1]; negative when there isn't enough history yet
+    double percentile(double q) const
+    {
+        std::array<double, window> sorted;
+        size_t n;
+        {
+            std::lock_guard<std::mutex> lg(mx);
+            n = count;
+            std::copy(samples.begin(), samples.begin() + (std::ptrdiff_t) n, sorted.begin());
+        }
+        if (n < minSamples)
+            return -1.0;
+
+        const auto k = std::min(n - 1, (size_t) (q * (double) n));
+        std::nth_element(sorted.begin(), sorted.begin() + (std::ptrdiff_t) k, sorted.begin() + (std::ptrdiff_t) n);
+        return sorted[k];
+    }
+
+    double p95() const { return percentile(0.95); }
+
+private:
+    mutable std::mutex mx;
+    std::array<double, window> samples {};
+    size_t next = 0, count = 0;
+};
@@ -0,0 +1,144 @@
+#include "BatchingTranslator.h"
+#include <memory>
+
+BatchingTranslator::BatchingTranslator(ITranslator& wrapped, const Config& c)
+: inner(wrapped), config(c)
+{
+    thread = std::thread(&BatchingTranslator::run, this);
+}
+
+BatchingTranslator::~BatchingTranslator()
+{
+    {
+        std::lock_guard<std::mutex> lg(mx);
+        stopping = true;
+    }
+    cv.notify_all();
+    thread.join();
+}
+
+std::string BatchingTranslator::translate(const TranslateRequest& r)
+{
+    return tryTranslate(r).text;
+}
+
+std::vector<std::string> BatchingTranslator::translateBatch(const std::vector<TranslateRequest>& batch)
+{
+    std::vector<std::string> out;
+    out.reserve(batch.size());
+    for (auto& r : tryTranslateBatch(batch))
+        out.push_back(std::move(r.text));
+    return out;
+}
+
+std::vector<TranslateResult> BatchingTranslator::tryTranslateBatch(const std::vector<TranslateRequest>& batch)
+{
+    // queued in one go, so the batching thread can't pick off the first alone
+    std::vector<std::future<TranslateResult>> futures;
+    std::vector<Pending> items;
+    futures.reserve(batch.size());
+    items.reserve(batch.size());
+    for (const auto& r : batch)
+    {
+        auto promise = std::make_shared<std::promise<TranslateResult>>();
+        futures.push_back(promise->get_future());
+        items.push_back({ r, [promise](TranslateResult result) { promise->set_value(std::move(result)); } });
+    }
+    enqueue(std::move(items));
+
+    std::vector<TranslateResult> out;
+    out.reserve(batch.size());
+    for (auto& f : futures)
+        out.push_back(f.get());
+    return out;
+}
+
+std::future<std::string> BatchingTranslator::translateAsync(const TranslateRequest& r)
+{
+    auto promise = std::make_shared<std::promise<std::string>>();
+    auto future = promise->get_future();
+    translateAsync(r, [promise](const std::string& s) { promise->set_value(s); });
+    return future;
+}
+
+void BatchingTranslator::translateAsync(const TranslateRequest& r, Callback onDone)
+{
+    std::vector<Pending> items;
+    items.push_back({ r, [onDone = std::move(onDone)](TranslateResult result) { onDone(result.text); } });
+    enqueue(std::move(items));
+}
+
+uint64_t BatchingTranslator::getRequestsSent() const
+{
+    std::lock_guard<std::mutex> lg(mx);
+    return requestsSent;
+}
+
+void BatchingTranslator::enqueue(std::vector<Pending> items)
+{
+    {
+        std::lock_guard<std::mutex> lg(mx);
+        if (queue.empty())
+            firstQueued = std::chrono::steady_clock::now();
+        for (auto& p : items)
+        {
+            queuedChars += p.request.text.size();
+            queue.push_back(std::move(p));
+        }
+    }
+    cv.notify_one();
+}
+
+void BatchingTranslator::run()
+{
+    std::unique_lock<std::mutex> lk(mx);
+    for (;;)
+    {
+        cv.wait(lk, [this] { return stopping || ! queue.empty(); });
+        if (queue.empty())
+            return; // stopping and drained
+
+        // hold the batch open until it's full or the oldest segment has waited
+        // long enough; a single segment has no one to wait for
+        if (queue.size() > 1)
+        {
+            const auto due = firstQueued + std::chrono::milliseconds(config.maxDelayMs);
+            cv.wait_until(lk, due, [this] {
+                return stopping || queue.size() >= config.maxSegments || queuedChars >= config.maxChars;
+            });
+        }
+
+        std::vector<Pending> batch;
+        size_t chars = 0;
+        auto it = queue.begin();
+        for (; it != queue.end() && batch.size() < config.maxSegments; ++it)
+        {
+            if (! batch.empty() && chars + it->request.text.size() > config.maxChars)
+                break;
+            chars += it->request.text.size();
+            batch.push_back(std::move(*it));
+        }
+        queue.erase(queue.begin(), it);
+        queuedChars -= chars;
+        if (! queue.empty())
+            firstQueued = {}; // leftovers of a full batch are already due
+        ++requestsSent;
+        lk.unlock();
+
+        std::vector<TranslateRequest> requests;
+        requests.reserve(batch.size());
+        for (const auto& p : batch)
+            requests.push_back(p.request);
+
+        auto results = inner.tryTranslateBatch(requests);
+        for (size_t i = 0; i < batch.size(); ++i)
+        {
+            if (i < results.size() && ! results[i].text.empty())
+                batch[i].onDone(std::move(results[i]));
+            else
+                batch[i].onDone({ batch[i].request.text, false });
+        }
+
+        lk.lock();
+    }
+}
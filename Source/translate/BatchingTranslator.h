@@ -0,0 +1,68 @@
+#pragma once
+#include <chrono>
+#include <condition_variable>
+#include <functional>
+#include <future>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+#include "ITranslator.h"
+
+// Front-end that coalesces segments from any number of callers into
+// translateBatch() calls on the wrapped backend. A batch goes out once
+// maxDelayMs has passed since its first segment, or as soon as it reaches
+// maxSegments / maxChars, whichever comes first. A lone segment on an idle
+// batcher goes out at once: nothing is in flight for others to queue behind,
+// so the delay would be pure latency. Segments that arrive while a batch is
+// in flight, or together (translateBatch), share the next request.
+// translate() blocks the caller like any other ITranslator;
+// translateAsync() returns a future.
+class BatchingTranslator : public ITranslator
+{
+public:
+    struct Config
+    {
+        int maxDelayMs = 10;
+        size_t maxSegments = 32;
+        size_t maxChars = 4000;   // stay well under the backend's request size limit
+    };
+
+    using Callback = std::function<void (const std::string& translated)>;
+
+    BatchingTranslator(ITranslator& inner, const Config& config);
+    explicit BatchingTranslator(ITranslator& inner) : BatchingTranslator(inner, Config {}) {}
+    ~BatchingTranslator() override;
+
+    std::string translate(const TranslateRequest& r) override;
+    std::vector<std::string> translateBatch(const std::vector<TranslateRequest>& batch) override;
+    std::vector<TranslateResult> tryTranslateBatch(const std::vector<TranslateRequest>& batch) override;
+
+    std::future<std::string> translateAsync(const TranslateRequest& r);
+    void translateAsync(const TranslateRequest& r, Callback onDone); // called on the batching thread
+
+    uint64_t getRequestsSent() const;
+
+private:
+    struct Pending
+    {
+        TranslateRequest request;
+        std::function<void (TranslateResult)> onDone;
+    };
+
+    void enqueue(std::vector<Pending> items);
+    void run();
+
+    ITranslator& inner;
+    const Config config;
+
+    mutable std::mutex mx;
+    std::condition_variable cv;
+    std::vector<Pending> queue;
+    size_t queuedChars = 0;
+    std::chrono::steady_clock::time_point firstQueued;
+    bool stopping = false;
+    uint64_t requestsSent = 0;
+
+    std::thread thread;
+};
@@ -0,0 +1,367 @@
+#include "CachingTranslator.h"
+#include <algorithm>
+#include <cstring>
+
+// Fixed-size open-addressed hash table in a memory-mapped file. Each slot
+// holds one key/value pair inline; pairs that don't fit a slot are simply
+// not persisted. A full probe run overwrites its first slot, so the table
+// never grows and stale phrases age out on their own.
+//
+// Several plugin instances, in this process or another, share the file.
+// Writers take a named InterProcessLock. Readers take no lock: each slot is a
+// small seqlock, where the hash is cleared before the slot is rewritten and
+// published last. A reader copies the slot out, re-reads the hash, and also
+// checks a checksum over the copy, so a torn read is a miss, never a wrong
+// translation.
+class CachingTranslator::DiskTable
+{
+public:
+    explicit DiskTable(const juce::File& f)
+    : file(f), writeLock("LiveTranslatorCache_" + juce::String::toHexString(f.getFullPathName().hashCode64()))
+    {
+        const juce::InterProcessLock::ScopedLockType lock(writeLock);
+        if (! open())
+        {
+            // missing, truncated or from another version: start over
+            file.getParentDirectory().createDirectory();
+            juce::MemoryBlock blank(fileSize, true);
+            std::memcpy(blank.getData(), &expectedHeader, sizeof(Header));
+            if (! file.replaceWithData(blank.getData(), blank.getSize()) || ! open())
+                mapped.reset();
+        }
+    }
+
+    bool isValid() const { return mapped != nullptr; }
+
+    bool find(const std::string& key, std::string& value) const
+    {
+        const uint64_t h = hash(key);
+        for (int i = 0; i < probes; ++i)
+        {
+            Slot* s = slot(h, i);
+            const uint64_t before = hashOf(s).load(std::memory_order_acquire);
+            if (before == 0)
+                return false;
+            if (before != h)
+                continue;
+
+            Slot copy;
+            std::memcpy(&copy, s, sizeof(Slot));
+            std::atomic_thread_fence(std::memory_order_acquire);
+            if (hashOf(s).load(std::memory_order_relaxed) != before)
+                return false; // being rewritten
+
+            if (copy.keyLen + (size_t) copy.valueLen > sizeof(Slot::bytes) || copy.check != checksum(h, copy))
+                return false;
+            if (copy.keyLen == key.size() && std::memcmp(copy.bytes, key.data(), key.size()) == 0)
+            {
+                value.assign(copy.bytes + copy.keyLen, copy.valueLen);
+                return true;
+            }
+        }
+        return false;
+    }
+
+    void store(const std::string& key, const std::string& value)
+    {
+        if (key.size() + value.size() > sizeof(Slot::bytes))
+            return;
+
+        const juce::InterProcessLock::ScopedLockType lock(writeLock);
+        const uint64_t h = hash(key);
+        Slot* target = slot(h, 0);
+        for (int i = 0; i < probes; ++i)
+        {
+            Slot* s = slot(h, i);
+            const uint64_t sh = hashOf(s).load(std::memory_order_relaxed);
+            if (sh == 0 || (sh == h && s->keyLen == key.size()
+                            && std::memcmp(s->bytes, key.data(), key.size()) == 0))
+            {
+                target = s;
+                break;
+            }
+        }
+
+        hashOf(target).store(0, std::memory_order_relaxed);
+        std::atomic_thread_fence(std::memory_order_release);
+        target->keyLen = (uint16_t) key.size();
+        target->valueLen = (uint16_t) value.size();
+        std::memcpy(target->bytes, key.data(), key.size());
+        std::memcpy(target->bytes + key.size(), value.data(), value.size());
+        target->check = checksum(h, *target);
+        hashOf(target).store(h, std::memory_order_release);
+    }
+
+    void clear()
+    {
+        if (! mapped)
+            return;
+
+        const juce::InterProcessLock::ScopedLockType lock(writeLock);
+        for (uint32_t i = 0; i < numSlots; ++i)
+        {
+            Slot* s = slot(i, 0);
+            hashOf(s).store(0, std::memory_order_relaxed);
+            std::atomic_thread_fence(std::memory_order_release);
+            std::memset(reinterpret_cast<char*>(s) + sizeof(uint64_t), 0, sizeof(Slot) - sizeof(uint64_t));
+        }
+    }
+
+private:
+    struct Header
+    {
+        char magic[4];
+        uint32_t version, numSlots, slotSize;
+    };
+
+    struct Slot
+    {
+        uint64_t hash;          // 0 = empty or being written; published last
+        uint32_t check;         // over hash, lengths and the bytes in use
+        uint16_t keyLen, valueLen;
+        char bytes[496];
+    };
+
+    static_assert(std::atomic<uint64_t>::is_always_lock_free && sizeof(std::atomic<uint64_t>) == sizeof(uint64_t),
+                  "the slot hash is shared between processes as a plain 64-bit word");
+
+    static constexpr uint32_t numSlots = 8192; // 4 MB
+    static constexpr int probes = 8;
+    static constexpr size_t fileSize = sizeof(Header) + (size_t) numSlots * sizeof(Slot);
+    static constexpr Header expectedHeader { { 'L', 'T', 'T', 'C' }, 2, numSlots, (uint32_t) sizeof(Slot) };
+
+    bool open()
+    {
+        if (file.getSize() != (juce::int64) fileSize)
+            return false;
+
+        mapped = std::make_unique<juce::MemoryMappedFile>(file, juce::MemoryMappedFile::readWrite);
+        if (mapped->getData() == nullptr || mapped->getSize() != fileSize
+            || std::memcmp(mapped->getData(), &expectedHeader, sizeof(Header)) != 0)
+        {
+            mapped.reset();
+            return false;
+        }
+        return true;
+    }
+
+    static uint64_t hash(const std::string& key)
+    {
+        uint64_t h = 14695981039346656037ull; // FNV-1a
+        for (unsigned char c : key)
+            h = (h ^ c) * 1099511628211ull;
+        return h == 0 ? 1 : h;
+    }
+
+    static uint32_t checksum(uint64_t h, const Slot& s)
+    {
+        uint64_t c = 14695981039346656037ull ^ h;
+        const auto mix = [&c](const void* p, size_t n) {
+            for (size_t i = 0; i < n; ++i)
+                c = (c ^ static_cast<const unsigned char*>(p)[i]) * 1099511628211ull;
+        };
+        mix(&s.keyLen, sizeof(s.keyLen));
+        mix(&s.valueLen, sizeof(s.valueLen));
+        mix(s.bytes, std::min(sizeof(s.bytes), (size_t) s.keyLen + s.valueLen));
+        return (uint32_t) (c ^ (c >> 32));
+    }
+
+    static std::atomic<uint64_t>& hashOf(Slot* s) { return *reinterpret_cast<std::atomic<uint64_t>*>(&s->hash); }
+
+    Slot* slot(uint64_t h, int probe) const
+    {
+        auto* base = reinterpret_cast<Slot*>(static_cast<char*>(mapped->getData()) + sizeof(Header));
+        return base + (size_t) ((h + (uint64_t) probe) % numSlots);
+    }
+
+    juce::File file;
+    juce::InterProcessLock writeLock; // across instances and processes sharing the file
+    std::unique_ptr<juce::MemoryMappedFile> mapped;
+};
+
+CachingTranslator::CachingTranslator(ITranslator& wrapped, const juce::File& storeFile, size_t maxEntries)
+: inner(wrapped), capacity(std::max<size_t>(1, maxEntries))
+{
+    if (storeFile != juce::File())
+    {
+        disk = std::make_unique<DiskTable>(storeFile);
+        if (! disk->isValid())
+            disk.reset();
+    }
+}
+
+CachingTranslator::~CachingTranslator() = default;
+
+juce::File CachingTranslator::defaultStoreFile()
+{
+    return juce::File::getSpecialLocation(juce::File::userApplicationDataDirectory)
+        .getChildFile("LiveTranslator").getChildFile("translations.cache");
+}
+
+std::string CachingTranslator::normalise(const std::string& text)
+{
+    auto words = juce::StringArray::fromTokens(juce::String::fromUTF8(text.c_str()).toLowerCase(), false);
+    words.removeEmptyStrings();
+    return words.joinIntoString(" ").toStdString();
+}
+
+std::string CachingTranslator::translate(const TranslateRequest& r)
+{
+    return translateBatch({ r }).front();
+}
+
+std::vector<std::string> CachingTranslator::translateBatch(const std::vector<TranslateRequest>& batch)
+{
+    std::vector<std::string> out(batch.size()), keys(batch.size());
+    std::vector<std::shared_future<std::string>> waits(batch.size()); // someone else's identical request
+    std::vector<size_t> fetch;                                        // ours to send, one promise each
+    std::vector<std::promise<std::string>> promises;
+    {
+        std::lock_guard<std::mutex> lg(mx);
+        for (size_t i = 0; i < batch.size(); ++i)
+        {
+            const auto& r = batch[i];
+            const std::string norm = normalise(r.text);
+            if (norm.empty())
+            {
+                out[i] = r.text;
+                continue;
+            }
+
+            keys[i] = r.srcLang + '\x1f' + r.dstLang + '\x1f' + norm;
+            if (lookup(keys[i], out[i]))
+            {
+                ++hits;
+                continue;
+            }
+
+            auto flight = inFlight.find(keys[i]);
+            if (flight != inFlight.end())
+            {
+                waits[i] = flight->second;
+                ++coalesced;
+                continue;
+            }
+
+            promises.emplace_back();
+            inFlight.emplace(keys[i], promises.back().get_future().share());
+            fetch.push_back(i);
+        }
+    }
+
+    if (! fetch.empty())
+    {
+        misses += fetch.size();
+        std::vector<TranslateRequest> requests;
+        requests.reserve(fetch.size());
+        for (size_t i : fetch)
+            requests.push_back(batch[i]);
+
+        std::vector<TranslateResult> results;
+        try
+        {
+            results = inner.tryTranslateBatch(requests);
+        }
+        catch (...)
+        {
+            // the waiters get the same exception instead of blocking forever
+            {
+                std::lock_guard<std::mutex> lg(mx);
+                for (size_t i : fetch)
+                    inFlight.erase(keys[i]);
+            }
+            for (auto& p : promises)
+                p.set_exception(std::current_exception());
+            throw;
+        }
+
+        for (size_t k = results.size(); k < requests.size(); ++k)
+            results.push_back({ requests[k].text, false });
+
+        {
+            std::lock_guard<std::mutex> lg(mx);
+            for (size_t k = 0; k < fetch.size(); ++k)
+            {
+                // a fallback answer (the input handed back, say) isn't worth pinning
+                if (results[k].ok && ! results[k].text.empty())
+                    insert(keys[fetch[k]], results[k].text);
+                inFlight.erase(keys[fetch[k]]);
+            }
+        }
+        // ours first: a duplicate later in this batch waits on one of them
+        for (size_t k = 0; k < fetch.size(); ++k)
+        {
+            promises[k].set_value(results[k].text);
+            out[fetch[k]] = std::move(results[k].text);
+        }
+    }
+
+    for (size_t i = 0; i < batch.size(); ++i)
+        if (waits[i].valid())
+            out[i] = waits[i].get();
+    return out;
+}
+
+bool CachingTranslator::lookup(const std::string& key, std::string& out)
+{
+    auto it = index.find(key);
+    if (it != index.end())
+    {
+        lru.splice(lru.begin(), lru, it->second);
+        out = it->second->second;
+        return true;
+    }
+
+    if (disk && disk->find(key, out))
+    {
+        ++diskHits;
+        remember(key, out);
+        return true;
+    }
+    return false;
+}
+
+void CachingTranslator::insert(const std::string& key, const std::string& value)
+{
+    remember(key, value);
+    if (disk)
+        disk->store(key, value);
+}
+
+void CachingTranslator::remember(const std::string& key, const std::string& value)
+{
+    auto it = index.find(key);
+    if (it != index.end())
+    {
+        it->second->second = value;
+        lru.splice(lru.begin(), lru, it->second);
+        return;
+    }
+
+    lru.emplace_front(key, value);
+    index[key] = lru.begin();
+    if (lru.size() > capacity)
+    {
+        index.erase(lru.back().first);
+        lru.pop_back();
+    }
+}
+
+CachingTranslator::Stats CachingTranslator::getStats() const
+{
+    Stats s;
+    s.hits = hits.load();
+    s.diskHits = diskHits.load();
+    s.misses = misses.load();
+    s.coalesced = coalesced.load();
+    return s;
+}
+
+void CachingTranslator::clear()
+{
+    std::lock_guard<std::mutex> lg(mx);
+    lru.clear();
+    index.clear();
+    if (disk)
+        disk->clear();
+}
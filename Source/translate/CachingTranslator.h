@@ -0,0 +1,61 @@
+#pragma once
+#include <atomic>
+#include <cstdint>
+#include <future>
+#include <list>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <unordered_map>
+#include <juce_core/juce_core.h>
+#include "ITranslator.h"
+
+// Caching decorator for any ITranslator. Entries are keyed by the src/dst
+// pair plus the normalised text (trimmed, whitespace collapsed, lower-cased)
+// and kept in an in-memory LRU backed by a memory-mapped on-disk table, so
+// recurring phrases survive across sessions. Concurrent requests for the
+// same key share a single call to the wrapped translator. translateBatch()
+// answers what it can from the cache and sends the misses on as one batch.
+class CachingTranslator : public ITranslator
+{
+public:
+    struct Stats
+    {
+        uint64_t hits = 0;       // memory or disk
+        uint64_t diskHits = 0;
+        uint64_t misses = 0;     // went to the wrapped translator
+        uint64_t coalesced = 0;  // waited on someone else's identical request
+    };
+
+    // storeFile: the persistent table; an invalid File keeps it memory-only
+    CachingTranslator(ITranslator& inner, const juce::File& storeFile, size_t maxEntries = 1024);
+    ~CachingTranslator() override;
+
+    std::string translate(const TranslateRequest& r) override;
+    std::vector<std::string> translateBatch(const std::vector<TranslateRequest>& batch) override;
+
+    Stats getStats() const;
+    void clear();
+
+    static std::string normalise(const std::string& text);
+    static juce::File defaultStoreFile();
+
+private:
+    class DiskTable;
+
+    bool lookup(const std::string& key, std::string& out); // mx held
+    void insert(const std::string& key, const std::string& value); // mx held
+    void remember(const std::string& key, const std::string& value); // mx held, memory only
+
+    ITranslator& inner;
+    const size_t capacity;
+
+    mutable std::mutex mx;
+    using Entry = std::pair<std::string, std::string>; // key, translation
+    std::list<Entry> lru;                               // most recent first
+    std::unordered_map<std::string, std::list<Entry>::iterator> index;
+    std::unordered_map<std::string, std::shared_future<std::string>> inFlight;
+    std::unique_ptr<DiskTable> disk;
+
+    std::atomic<uint64_t> hits { 0 }, diskHits { 0 }, misses { 0 }, coalesced { 0 };
+};
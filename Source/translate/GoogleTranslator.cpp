@@ -1,57 +1,99 @@
 #include "GoogleTranslator.h"
 #include <juce_core/juce_core.h>
+#include <map>
+#include "../net/HttpClient.h"
 
 std::string GoogleTranslator::translate(const TranslateRequest& r)
 {
-    if (key.isEmpty() || r.text.empty())
-        return r.text; // fallback
+    return translateBatch({ r }).front();
+}
 
-    auto src = toGoogleLang(r.srcLang);
-    auto dst = toGoogleLang(r.dstLang);
+void GoogleTranslator::prewarm()
+{
+    if (key.isNotEmpty())
+        HttpClient::shared().prewarm(endpoint);
+}
 
-    juce::URL url("https://translation.googleapis.com/language/translate/v2");
+std::vector<std::string> GoogleTranslator::translateBatch(const std::vector<TranslateRequest>& batch)
+{
+    std::vector<std::string> out;
+    out.reserve(batch.size());
+    for (auto& r : tryTranslateBatch(batch))
+        out.push_back(std::move(r.text));
+    return out;
+}
 
-    url = url
-        .withParameter("key", key)
-        .withParameter("q",  juce::String(r.text))
-        .withParameter("source", src)
-        .withParameter("target", dst)
-        .withParameter("format", "text");
+std::vector<TranslateResult> GoogleTranslator::tryTranslateBatch(const std::vector<TranslateRequest>& batch)
+{
+    std::vector<TranslateResult> out;
+    out.reserve(batch.size());
+    for (const auto& r : batch)
+        out.push_back({ r.text, r.text.empty() }); // fallback; nothing to translate is no failure
 
-    juce::String response = url.readEntireTextStream();
+    if (key.isEmpty())
+        return out;
 
-    if (response.isEmpty())
-        return r.text;
+    // one request per language pair, preserving order within each
+    std::map<std::pair<juce::String, juce::String>, std::vector<size_t>> groups;
+    for (size_t i = 0; i < batch.size(); ++i)
+        if (! batch[i].text.empty())
+            groups[{ toGoogleLang(batch[i].srcLang), toGoogleLang(batch[i].dstLang) }].push_back(i);
 
-    juce::var resVar = juce::JSON::parse(response);
-    if (! resVar.isObject())
-        return r.text;
+    for (const auto& [pair, indices] : groups)
+    {
+        // the most patient caller in the group sets the HTTP timeout
+        juce::StringArray texts, results;
+        int timeoutMs = 0;
+        for (auto i : indices)
+        {
+            texts.add(juce::String::fromUTF8(batch[i].text.c_str()));
+            timeoutMs = std::max(timeoutMs, batch[i].budgetMs);
+        }
 
-    auto* root = resVar.getDynamicObject();
-    if (!root)
-        return r.text;
+        if (! post(texts, pair.first, pair.second, timeoutMs > 0 ? timeoutMs : defaultTimeoutMs, results))
+            continue;
 
-    auto data = root->getProperty("data");
-    if (!data.isObject())
-        return r.text;
+        for (int j = 0; j < results.size() && j < (int) indices.size(); ++j)
+            out[indices[(size_t) j]] = { results[j].toStdString(), true };
+    }
+    return out;
+}
 
-    auto* dataObj = data.getDynamicObject();
-    if (!dataObj)
-        return r.text;
+bool GoogleTranslator::post(const juce::StringArray& texts, const juce::String& src, const juce::String& dst,
+                            int timeoutMs, juce::StringArray& results) const
+{
+    // form-encoded body: the q parameter repeats once per segment
+    juce::String body;
+    body << "key=" << juce::URL::addEscapeChars(key, true);
+    for (const auto& t : texts)
+        body << "&q=" << juce::URL::addEscapeChars(t, true);
+    if (src != "auto") // omitted source = detect
+        body << "&source=" << juce::URL::addEscapeChars(src, true);
+    body << "&target=" << juce::URL::addEscapeChars(dst, true) << "&format=text";
 
-    auto translations = dataObj->getProperty("translations");
-    if (!translations.isArray())
-        return r.text;
+    HttpRequest request;
+    request.url = endpoint;
+    request.timeoutMs = timeoutMs;
+    request.headers.set("Content-Type", "application/x-www-form-urlencoded");
+    request.body.append(body.toRawUTF8(), body.getNumBytesAsUTF8());
 
-    auto* arr = translations.getArray();
-    if (!arr || arr->isEmpty())
-        return r.text;
+    const auto response = HttpClient::shared().send(request);
+    if (! response.ok())
+        return false;
+
+    juce::var resVar = juce::JSON::parse(response.body.toString());
+    if (! resVar.isObject())
+        return false;
 
-    auto entry = (*arr)[0];
-    if (!entry.isObject())
-        return r.text;
+    auto data = resVar.getProperty("data", {});
+    if (! data.isObject())
+        return false;
 
-    juce::String translated = entry.getProperty("translatedText", juce::String(r.text));
+    auto* arr = data.getProperty("translations", {}).getArray();
+    if (! arr || arr->size() != texts.size())
+        return false;
 
-    return translated.toStdString();
+    for (int i = 0; i < arr->size(); ++i)
+        results.add((*arr)[i].getProperty("translatedText", texts[i]).toString());
+    return true;
 }
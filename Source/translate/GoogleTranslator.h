@@ -17,12 +17,30 @@ public:
         key = apiKey;
     }
 
+    // v2 REST endpoint; overridable for a local stand-in server
+    void setEndpoint(const juce::String& url) { endpoint = url; }
+
+    // Opens a pooled connection to the endpoint ahead of the first request
+    void prewarm();
+
     // Blocking call for now (fast enough for short phrases),
     // You can swap to async thread later if needed.
     std::string translate(const TranslateRequest& r) override;
 
+    // Segments sharing a language pair go out as one POST with several q
+    // parameters; anything that fails comes back untranslated.
+    std::vector<std::string> translateBatch(const std::vector<TranslateRequest>& batch) override;
+    std::vector<TranslateResult> tryTranslateBatch(const std::vector<TranslateRequest>& batch) override; // failures marked
+
 private:
     juce::String key;
+    juce::String endpoint { "https://translation.googleapis.com/language/translate/v2" };
+
+    // one POST for texts sharing src/dst; false if the response didn't parse
+    bool post(const juce::StringArray& texts, const juce::String& src, const juce::String& dst,
+              int timeoutMs, juce::StringArray& results) const;
+
+    static constexpr int defaultTimeoutMs = 5000;
 
     juce::String toGoogleLang(const std::string& lang) const
     {
@@ -1,14 +1,50 @@
 #pragma once
 #include <string>
+#include <vector>
 
 struct TranslateRequest {
     std::string text;
     std::string srcLang; // "auto" allowed
     std::string dstLang; // e.g., "de", "en", "fr"
+    int budgetMs = 0;    // latency budget for this utterance, 0 = backend default
+};
+
+// A result and whether the backend actually produced it. Backends hand the
+// input back when they fail, which can't be told apart from a correct
+// translation that happens to read the same, so they say which it was.
+struct TranslateResult {
+    std::string text;
+    bool ok = true;
 };
 
 class ITranslator {
 public:
     virtual ~ITranslator() = default;
     virtual std::string translate(const TranslateRequest& r) = 0;
+
+    // One result per request, in order. Backends that can send several
+    // segments per round trip override this; the default just loops.
+    virtual std::vector<std::string> translateBatch(const std::vector<TranslateRequest>& batch) {
+        std::vector<std::string> out;
+        out.reserve(batch.size());
+        for (const auto& r : batch)
+            out.push_back(translate(r));
+        return out;
+    }
+
+    // translateBatch() with each result's outcome. Backends that can fail
+    // override this (and answer translate / translateBatch from it); the
+    // default trusts every result.
+    virtual std::vector<TranslateResult> tryTranslateBatch(const std::vector<TranslateRequest>& batch) {
+        std::vector<TranslateResult> out;
+        out.reserve(batch.size());
+        for (auto& text : translateBatch(batch))
+            out.push_back({ std::move(text), true });
+        return out;
+    }
+
+    TranslateResult tryTranslate(const TranslateRequest& r) {
+        auto results = tryTranslateBatch({ r });
+        return results.empty() ? TranslateResult { r.text, false } : std::move(results.front());
+    }
 };
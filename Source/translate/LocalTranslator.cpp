@@ -0,0 +1,188 @@
+#include "LocalTranslator.h"
+#include <algorithm>
+#include "../engine/InferenceScheduler.h"
+
+LocalTranslator::LocalTranslator(ITranslator& f, const juce::File& modelDir, const Config& c)
+: fallback(f), dir(modelDir), config(c), stream(InferenceScheduler::instance().registerStream())
+{
+}
+
+LocalTranslator::~LocalTranslator()
+{
+    InferenceScheduler::instance().unregisterStream(stream);
+}
+
+std::string LocalTranslator::translate(const TranslateRequest& r)
+{
+    return translateBatch({ r }).front();
+}
+
+std::vector<std::string> LocalTranslator::translateBatch(const std::vector<TranslateRequest>& batch)
+{
+    std::vector<std::string> out;
+    out.reserve(batch.size());
+    for (auto& r : tryTranslateBatch(batch))
+        out.push_back(std::move(r.text));
+    return out;
+}
+
+std::vector<TranslateResult> LocalTranslator::tryTranslateBatch(const std::vector<TranslateRequest>& batch)
+{
+    std::vector<TranslateResult> out;
+    out.reserve(batch.size());
+    for (const auto& r : batch)
+        out.push_back({ r.text, false }); // until the model or the fallback answers
+
+    // group by language pair, keeping each request's slot
+    std::map<std::string, std::vector<size_t>> groups;
+    for (size_t i = 0; i < batch.size(); ++i)
+        groups[pairKey(batch[i].srcLang, batch[i].dstLang)].push_back(i);
+
+    std::vector<size_t> remote;
+    for (auto& [key, which] : groups)
+    {
+        const auto& first = batch[which.front()];
+        MarianModel* model = modelFor(first.srcLang, first.dstLang);
+
+        // shortest first, so each chunk pads as little as possible
+        std::sort(which.begin(), which.end(), [&] (size_t a, size_t b) { return batch[a].text.size() < batch[b].text.size(); });
+
+        for (size_t start = 0; start < which.size(); start += config.maxBatch)
+        {
+            const std::vector<size_t> chunk(which.begin() + (std::ptrdiff_t) start,
+                                            which.begin() + (std::ptrdiff_t) std::min(which.size(), start + config.maxBatch));
+            if (model == nullptr || ! runLocal(*model, batch, chunk, out))
+                remote.insert(remote.end(), chunk.begin(), chunk.end());
+        }
+    }
+
+    if (! remote.empty())
+    {
+        fallbacks += remote.size();
+
+        std::vector<TranslateRequest> rest;
+        rest.reserve(remote.size());
+        for (size_t i : remote)
+            rest.push_back(batch[i]);
+
+        auto translated = fallback.tryTranslateBatch(rest);
+        for (size_t j = 0; j < remote.size() && j < translated.size(); ++j)
+            out[remote[j]] = std::move(translated[j]);
+    }
+    return out;
+}
+
+bool LocalTranslator::runLocal(MarianModel& model, const std::vector<TranslateRequest>& batch,
+                               const std::vector<size_t>& which, std::vector<TranslateResult>& out)
+{
+    std::vector<std::string> texts;
+    int budgetMs = 0;
+    for (size_t i : which)
+    {
+        texts.push_back(batch[i].text);
+        budgetMs = std::max(budgetMs, batch[i].budgetMs);
+    }
+
+    const double t0 = juce::Time::getMillisecondCounterHiRes();
+    const double deadline = t0 + (budgetMs > 0 ? budgetMs : config.defaultBudgetMs);
+
+    std::vector<std::string> results;
+    InferenceScheduler::instance().run(stream, deadline, [&](int threads) {
+        results = model.translate(texts, threads);
+    });
+
+    decodeUs += (uint64_t) ((juce::Time::getMillisecondCounterHiRes() - t0) * 1000.0);
+    ++batches;
+
+    if (results.size() != which.size())
+        return false;
+
+    // an empty result for non-empty input means the model gave up; let the fallback try
+    for (size_t j = 0; j < which.size(); ++j)
+        if (results[j].empty() && ! texts[j].empty())
+            return false;
+
+    for (size_t j = 0; j < which.size(); ++j)
+        out[which[j]] = { std::move(results[j]), true };
+    sentences += which.size();
+    return true;
+}
+
+MarianModel* LocalTranslator::modelFor(const std::string& src, const std::string& dst)
+{
+    if (src.empty() || src == "auto" || src == dst)
+        return nullptr;
+
+    const auto key = pairKey(src, dst);
+    {
+        std::lock_guard<std::mutex> lg(mx);
+        if (disabled.count(key) != 0)
+            return nullptr;
+
+        auto it = models.find(key);
+        if (it != models.end())
+            return it->second.get();
+
+        // someone else is mapping it: this one goes to the fallback rather than wait
+        if (! loading.insert(key).second)
+            return nullptr;
+    }
+
+    // mapping a model can take a while on a cold disk; other pairs (and
+    // loaded ones) keep translating meanwhile
+    const auto file = modelFile(src, dst);
+    juce::String error;
+    auto model = file.existsAsFile() ? MarianModel::load(file, error) : nullptr;
+    if (error.isNotEmpty() && onLog)
+        onLog("LocalTranslator: " + error);
+
+    std::lock_guard<std::mutex> lg(mx);
+    loading.erase(key);
+    auto* loaded = models.emplace(key, std::move(model)).first->second.get();
+    return disabled.count(key) != 0 ? nullptr : loaded;
+}
+
+void LocalTranslator::setPairEnabled(const std::string& src, const std::string& dst, bool enabled)
+{
+    std::lock_guard<std::mutex> lg(mx);
+    if (enabled) disabled.erase(pairKey(src, dst));
+    else         disabled.insert(pairKey(src, dst));
+}
+
+bool LocalTranslator::hasModel(const std::string& src, const std::string& dst) const
+{
+    return modelFile(src, dst).existsAsFile();
+}
+
+void LocalTranslator::preload(const std::string& src, const std::string& dst)
+{
+    {
+        // forget an earlier miss, in case the model has been installed since
+        std::lock_guard<std::mutex> lg(mx);
+        auto it = models.find(pairKey(src, dst));
+        if (it != models.end() && it->second == nullptr)
+            models.erase(it);
+    }
+    modelFor(src, dst);
+}
+
+LocalTranslator::Stats LocalTranslator::getStats() const
+{
+    Stats s;
+    s.sentences = sentences;
+    s.batches = batches;
+    s.fallbacks = fallbacks;
+    s.decodeMs = (double) decodeUs.load() / 1000.0;
+    return s;
+}
+
+juce::File LocalTranslator::modelFile(const std::string& src, const std::string& dst) const
+{
+    return dir.getChildFile("opus-mt-" + juce::String(pairKey(src, dst)) + ".gguf");
+}
+
+juce::File LocalTranslator::defaultModelDir()
+{
+    return juce::File::getSpecialLocation(juce::File::userApplicationDataDirectory)
+        .getChildFile("LiveTranslator").getChildFile("mt");
+}
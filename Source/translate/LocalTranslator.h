@@ -0,0 +1,83 @@
+#pragma once
+#include <atomic>
+#include <functional>
+#include <cstdint>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <set>
+#include <string>
+#include <juce_core/juce_core.h>
+#include "ITranslator.h"
+#include "MarianModel.h"
+
+// On-device translation. A language pair is handled locally when
+// <modelDir>/opus-mt-<src>-<dst>.gguf exists and the pair hasn't been
+// disabled; everything else (including "auto" sources, and any local
+// failure) goes to the fallback backend. Models load lazily on first use
+// and stay mapped. Decodes run on the shared InferenceScheduler so they
+// share the core budget with whisper instead of competing with it.
+class LocalTranslator : public ITranslator
+{
+public:
+    struct Config
+    {
+        size_t maxBatch = 8;        // sentences decoded together
+        int defaultBudgetMs = 2000; // scheduler deadline when the request has none
+    };
+
+    struct Stats
+    {
+        uint64_t sentences = 0, batches = 0, fallbacks = 0;
+        double decodeMs = 0.0;      // total time in local decodes
+    };
+
+    using OnLogFn = std::function<void (const juce::String& line)>;
+
+    LocalTranslator(ITranslator& fallback, const juce::File& modelDir, const Config& config);
+    LocalTranslator(ITranslator& fallback, const juce::File& modelDir) : LocalTranslator(fallback, modelDir, Config {}) {}
+    ~LocalTranslator() override;
+
+    std::string translate(const TranslateRequest& r) override;
+    std::vector<std::string> translateBatch(const std::vector<TranslateRequest>& batch) override;
+    std::vector<TranslateResult> tryTranslateBatch(const std::vector<TranslateRequest>& batch) override; // failures marked
+
+    // Per-pair switch; pairs are enabled by default when a model is present
+    void setPairEnabled(const std::string& src, const std::string& dst, bool enabled);
+    bool hasModel(const std::string& src, const std::string& dst) const;
+
+    // Maps the pair's model now rather than on the first utterance, and
+    // picks up a model installed since the pair was last looked up
+    void preload(const std::string& src, const std::string& dst);
+
+    Stats getStats() const;
+
+    // Model load failures; called on whichever thread did the load. Set before first use
+    void setLogCallback(OnLogFn cb) { onLog = std::move(cb); }
+
+    static juce::File defaultModelDir();
+
+private:
+    static std::string pairKey(const std::string& src, const std::string& dst) { return src + "-" + dst; }
+
+    juce::File modelFile(const std::string& src, const std::string& dst) const;
+    MarianModel* modelFor(const std::string& src, const std::string& dst);
+
+    // translates batch[i] for every i in 'which' with the pair's model; false on failure
+    bool runLocal(MarianModel& model, const std::vector<TranslateRequest>& batch,
+                  const std::vector<size_t>& which, std::vector<TranslateResult>& out);
+
+    ITranslator& fallback;
+    const juce::File dir;
+    const Config config;
+    const int stream;
+
+    mutable std::mutex mx;
+    std::map<std::string, std::unique_ptr<MarianModel>> models; // null = no usable model for the pair
+    std::set<std::string> loading;  // pairs being loaded, outside mx; they fall back meanwhile
+    std::set<std::string> disabled;
+    OnLogFn onLog;
+
+    std::atomic<uint64_t> sentences { 0 }, batches { 0 }, fallbacks { 0 };
+    std::atomic<uint64_t> decodeUs { 0 };
+};
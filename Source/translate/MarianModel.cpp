@@ -0,0 +1,548 @@
+#include "MarianModel.h"
+#include <algorithm>
+#include <cmath>
+#include <cstring>
+
+#include "ggml.h"
+#include "ggml-cpu.h"
+#include "gguf.h"
+
+#if JUCE_LINUX || JUCE_MAC || JUCE_BSD
+ #include <sys/mman.h>
+#endif
+
+namespace
+{
+    constexpr int maxGraphNodes = 4096;
+
+    int getInt(const gguf_context* g, const char* key, int fallback)
+    {
+        const auto idx = gguf_find_key(g, key);
+        if (idx < 0)
+            return fallback;
+
+        switch (gguf_get_kv_type(g, idx))
+        {
+            case GGUF_TYPE_UINT32: return (int) gguf_get_val_u32(g, idx);
+            case GGUF_TYPE_INT32:  return (int) gguf_get_val_i32(g, idx);
+            default:               return fallback;
+        }
+    }
+
+    bool getBool(const gguf_context* g, const char* key, bool fallback)
+    {
+        const auto idx = gguf_find_key(g, key);
+        return idx >= 0 && gguf_get_kv_type(g, idx) == GGUF_TYPE_BOOL ? gguf_get_val_bool(g, idx) : fallback;
+    }
+
+    std::string getString(const gguf_context* g, const char* key)
+    {
+        const auto idx = gguf_find_key(g, key);
+        return idx >= 0 && gguf_get_kv_type(g, idx) == GGUF_TYPE_STRING ? gguf_get_val_str(g, idx) : std::string();
+    }
+}
+
+std::unique_ptr<MarianModel> MarianModel::load(const juce::File& file, juce::String& error)
+{
+    if (! file.existsAsFile())
+    {
+        error = "no such file: " + file.getFullPathName();
+        return nullptr;
+    }
+
+    std::unique_ptr<MarianModel> m(new MarianModel());
+
+    m->mapped = std::make_unique<juce::MemoryMappedFile>(file, juce::MemoryMappedFile::readOnly);
+    if (m->mapped->getData() == nullptr)
+    {
+        error = "cannot map " + file.getFileName();
+        return nullptr;
+    }
+
+    // metadata only; tensor data stays in the mapping
+    gguf_init_params params { /*no_alloc*/ true, /*ctx*/ &m->weights };
+    gguf_context* g = gguf_init_from_file(file.getFullPathName().toRawUTF8(), params);
+    if (g == nullptr)
+    {
+        error = file.getFileName() + " is not a GGUF file";
+        return nullptr;
+    }
+
+    auto& hp = m->hp;
+    hp.dModel         = getInt(g, "marian.d_model", hp.dModel);
+    hp.nHeads         = getInt(g, "marian.n_heads", hp.nHeads);
+    hp.encLayers      = getInt(g, "marian.encoder_layers", hp.encLayers);
+    hp.decLayers      = getInt(g, "marian.decoder_layers", hp.decLayers);
+    hp.ffnDim         = getInt(g, "marian.ffn_dim", hp.ffnDim);
+    hp.maxLen         = getInt(g, "marian.max_len", hp.maxLen);
+    hp.posOffset      = getInt(g, "marian.pos_offset", hp.posOffset);
+    hp.preNorm        = getBool(g, "marian.pre_norm", hp.preNorm);
+    hp.scaleEmbedding = getBool(g, "marian.scale_embedding", hp.scaleEmbedding);
+
+    const std::string act = getString(g, "marian.activation");
+    hp.activation = act == "relu" ? HParams::Activation::relu
+                  : act == "gelu" ? HParams::Activation::gelu
+                                  : HParams::Activation::swish;
+
+    hp.eos          = getInt(g, "tokenizer.eos_id", hp.eos);
+    hp.pad          = getInt(g, "tokenizer.pad_id", hp.pad);
+    hp.unk          = getInt(g, "tokenizer.unk_id", hp.unk);
+    hp.decoderStart = getInt(g, "tokenizer.decoder_start_id", hp.pad);
+    hp.srcPrefix    = getInt(g, "tokenizer.src_prefix_id", -1);
+    hp.forcedBos    = getInt(g, "tokenizer.forced_bos_id", -1);
+
+    const auto tokensKey = gguf_find_key(g, "tokenizer.ggml.tokens");
+    const auto scoresKey = gguf_find_key(g, "tokenizer.ggml.scores");
+    if (tokensKey >= 0 && gguf_get_arr_type(g, tokensKey) == GGUF_TYPE_STRING)
+    {
+        const size_t n = gguf_get_arr_n(g, tokensKey);
+        std::vector<std::string> pieces(n);
+        std::vector<float> scores(n, 0.0f);
+        for (size_t i = 0; i < n; ++i)
+            pieces[i] = gguf_get_arr_str(g, tokensKey, i);
+
+        if (scoresKey >= 0 && gguf_get_arr_type(g, scoresKey) == GGUF_TYPE_FLOAT32 && gguf_get_arr_n(g, scoresKey) == n)
+        {
+            const auto* s = static_cast<const float*>(gguf_get_arr_data(g, scoresKey));
+            scores.assign(s, s + n);
+        }
+        m->tokenizer.load(std::move(pieces), std::move(scores), hp.unk);
+    }
+
+    // point every tensor at its bytes in the mapping
+    const auto* base = static_cast<const char*>(m->mapped->getData());
+    const size_t size = m->mapped->getSize();
+    const size_t dataOffset = gguf_get_data_offset(g);
+    bool inBounds = true;
+
+    for (int64_t i = 0; i < gguf_get_n_tensors(g); ++i)
+    {
+        ggml_tensor* t = ggml_get_tensor(m->weights, gguf_get_tensor_name(g, i));
+        const size_t offset = dataOffset + gguf_get_tensor_offset(g, i);
+        if (t == nullptr || offset + ggml_nbytes(t) > size)
+        {
+            inBounds = false;
+            break;
+        }
+        t->data = const_cast<char*>(base + offset);
+    }
+    gguf_free(g);
+
+    if (! inBounds)
+    {
+        error = file.getFileName() + " is truncated";
+        return nullptr;
+    }
+
+    if (! m->tokenizer.isLoaded() || ! m->bindTensors(error))
+    {
+        if (error.isEmpty())
+            error = file.getFileName() + " has no vocabulary";
+        return nullptr;
+    }
+
+   #if JUCE_LINUX || JUCE_MAC || JUCE_BSD
+    madvise(m->mapped->getData(), m->mapped->getSize(), MADV_WILLNEED);
+   #endif
+
+    m->buildConstants();
+    return m;
+}
+
+MarianModel::~MarianModel()
+{
+    if (state.ctx)  ggml_free(state.ctx);
+    if (constants)  ggml_free(constants);
+    if (weights)    ggml_free(weights);
+}
+
+bool MarianModel::bindTensors(juce::String& error)
+{
+    bool missing = false;
+    auto get = [&] (const juce::String& name, bool required = true) -> ggml_tensor*
+    {
+        ggml_tensor* t = ggml_get_tensor(weights, name.toRawUTF8());
+        if (t == nullptr && required)
+        {
+            if (! missing)
+                error = "missing tensor " + name;
+            missing = true;
+        }
+        return t;
+    };
+    auto linear = [&] (const juce::String& prefix) { return Linear { get(prefix + ".w"), get(prefix + ".b") }; };
+    auto norm   = [&] (const juce::String& prefix, bool required = true) { return Norm { get(prefix + ".w", required), get(prefix + ".b", required) }; };
+    auto attention = [&] (const juce::String& prefix)
+    {
+        return Attention { linear(prefix + ".q"), linear(prefix + ".k"), linear(prefix + ".v"), linear(prefix + ".o") };
+    };
+
+    embed = get("embed_tokens.weight");
+    lmHead = get("lm_head.weight", false);
+
+    enc.resize((size_t) hp.encLayers);
+    for (int i = 0; i < hp.encLayers; ++i)
+    {
+        const juce::String p = "enc." + juce::String(i);
+        auto& l = enc[(size_t) i];
+        l.attn   = attention(p + ".attn");
+        l.attnLn = norm(p + ".attn_ln");
+        l.fc1    = linear(p + ".fc1");
+        l.fc2    = linear(p + ".fc2");
+        l.ffnLn  = norm(p + ".ffn_ln");
+    }
+
+    dec.resize((size_t) hp.decLayers);
+    for (int i = 0; i < hp.decLayers; ++i)
+    {
+        const juce::String p = "dec." + juce::String(i);
+        auto& l = dec[(size_t) i];
+        l.attn    = attention(p + ".attn");
+        l.attnLn  = norm(p + ".attn_ln");
+        l.cross   = attention(p + ".cross");
+        l.crossLn = norm(p + ".cross_ln");
+        l.fc1     = linear(p + ".fc1");
+        l.fc2     = linear(p + ".fc2");
+        l.ffnLn   = norm(p + ".ffn_ln");
+    }
+
+    encLn = norm("enc.ln", false);
+    decLn = norm("dec.ln", false);
+
+    if (missing)
+        return false;
+
+    if (hp.nHeads <= 0 || hp.dModel % hp.nHeads != 0 || embed->ne[0] != hp.dModel)
+    {
+        error = "inconsistent model dimensions";
+        return false;
+    }
+
+    hp.vocab = (int) embed->ne[1];
+    if (lmHead == nullptr)
+        lmHead = embed; // tied, as in opus-mt
+    return true;
+}
+
+void MarianModel::buildConstants()
+{
+    const int d = hp.dModel, half = d / 2;
+    const int rows = hp.maxLen + hp.posOffset;
+
+    ggml_init_params params { ggml_tensor_overhead() * 2 + (size_t) (d * rows + hp.vocab) * sizeof(float) + 1024, nullptr, false };
+    constants = ggml_init(params);
+
+    // Sinusoidal positions, sin in the first half of each row and cos in the
+    // second. Fairseq-derived models (NLLB / M2M; the ones with a position
+    // offset) space the frequencies over half-1 steps instead of d/2.
+    positions = ggml_new_tensor_2d(constants, GGML_TYPE_F32, d, rows);
+    auto* pos = static_cast<float*>(positions->data);
+    const double step = hp.posOffset > 0 ? std::log(10000.0) / (half - 1) : std::log(10000.0) * 2.0 / d;
+    for (int p = 0; p < rows; ++p)
+    {
+        const int at = std::max(0, p - hp.posOffset); // rows below the offset belong to padding
+        for (int j = 0; j < half; ++j)
+        {
+            const double angle = at * std::exp(-step * j);
+            pos[(size_t) p * d + j] = (float) std::sin(angle);
+            pos[(size_t) p * d + half + j] = (float) std::cos(angle);
+        }
+    }
+
+    // final_logits_bias (f32 or f16 in the file), with pad never chosen
+    outputBias = ggml_new_tensor_1d(constants, GGML_TYPE_F32, hp.vocab);
+    auto* bias = static_cast<float*>(outputBias->data);
+    std::fill(bias, bias + hp.vocab, 0.0f);
+
+    if (const ggml_tensor* b = ggml_get_tensor(weights, "final_logits_bias"); b != nullptr && ggml_nelements(b) == hp.vocab)
+    {
+        if (b->type == GGML_TYPE_F32)
+            std::memcpy(bias, b->data, (size_t) hp.vocab * sizeof(float));
+        else if (b->type == GGML_TYPE_F16)
+            ggml_fp16_to_fp32_row(static_cast<const ggml_fp16_t*>(b->data), bias, hp.vocab);
+    }
+    if (hp.pad >= 0 && hp.pad < hp.vocab)
+        bias[hp.pad] = -INFINITY;
+}
+
+void MarianModel::beginBatch(int batch, int srcLen, int steps)
+{
+    const size_t d = (size_t) hp.dModel;
+    const size_t layers = (size_t) hp.decLayers;
+    const size_t floats = layers * 2 * d * (size_t) batch * ((size_t) steps + (size_t) srcLen) + (size_t) (srcLen * batch);
+    const size_t bytes = floats * sizeof(float) + ggml_tensor_overhead() * (layers * 4 + 1) + 4096;
+
+    if (state.ctx)
+        ggml_free(state.ctx);
+
+    // the buffer only ever grows, so steady-state batches allocate nothing
+    if (stateBuffer.size() < bytes)
+        stateBuffer.resize(bytes);
+
+    ggml_init_params params { stateBuffer.size(), stateBuffer.data(), false };
+    state.ctx = ggml_init(params);
+    state.batch = batch;
+    state.srcLen = srcLen;
+    state.steps = steps;
+
+    const int hd = hp.dModel / hp.nHeads;
+    state.selfK.assign(layers, nullptr);
+    state.selfV.assign(layers, nullptr);
+    state.crossK.assign(layers, nullptr);
+    state.crossV.assign(layers, nullptr);
+
+    for (size_t l = 0; l < layers; ++l)
+    {
+        state.selfK[l]  = ggml_new_tensor_4d(state.ctx, GGML_TYPE_F32, hd, steps, hp.nHeads, batch);
+        state.selfV[l]  = ggml_new_tensor_4d(state.ctx, GGML_TYPE_F32, steps, hd, hp.nHeads, batch);
+        state.crossK[l] = ggml_new_tensor_4d(state.ctx, GGML_TYPE_F32, hd, srcLen, hp.nHeads, batch);
+        state.crossV[l] = ggml_new_tensor_4d(state.ctx, GGML_TYPE_F32, srcLen, hd, hp.nHeads, batch);
+    }
+    state.srcMask = ggml_new_tensor_4d(state.ctx, GGML_TYPE_F32, srcLen, 1, 1, batch);
+}
+
+ggml_context* MarianModel::newComputeContext(size_t bytes)
+{
+    bytes += ggml_tensor_overhead() * maxGraphNodes + ggml_graph_overhead_custom(maxGraphNodes, false);
+    if (computeBuffer.size() < bytes)
+        computeBuffer.resize(bytes);
+
+    ggml_init_params params { computeBuffer.size(), computeBuffer.data(), false };
+    return ggml_init(params);
+}
+
+ggml_tensor* MarianModel::linear(ggml_context* ctx, ggml_tensor* x, const Linear& l) const
+{
+    return ggml_add(ctx, ggml_mul_mat(ctx, l.w, x), l.b);
+}
+
+ggml_tensor* MarianModel::norm(ggml_context* ctx, ggml_tensor* x, const Norm& n) const
+{
+    return ggml_add(ctx, ggml_mul(ctx, ggml_norm(ctx, x, 1e-5f), n.w), n.b);
+}
+
+ggml_tensor* MarianModel::activation(ggml_context* ctx, ggml_tensor* x) const
+{
+    switch (hp.activation)
+    {
+        case HParams::Activation::relu: return ggml_relu(ctx, x);
+        case HParams::Activation::gelu: return ggml_gelu(ctx, x);
+        case HParams::Activation::swish: break;
+    }
+    return ggml_silu(ctx, x);
+}
+
+// q [hd, nq, heads, B], k [hd, nk, heads, B], vT [nk, hd, heads, B],
+// mask [nk, 1, 1, B] or null -> [d, nq * B]
+ggml_tensor* MarianModel::attend(ggml_context* ctx, ggml_tensor* q, ggml_tensor* k, ggml_tensor* vT,
+                                 ggml_tensor* mask, int numQueries, int batch) const
+{
+    const int hd = hp.dModel / hp.nHeads;
+
+    ggml_tensor* kq = ggml_mul_mat(ctx, k, q);                       // [nk, nq, heads, B]
+    kq = ggml_scale(ctx, kq, 1.0f / std::sqrt((float) hd));
+    if (mask != nullptr)
+        kq = ggml_add(ctx, kq, mask);
+    kq = ggml_soft_max(ctx, kq);
+
+    ggml_tensor* kqv = ggml_mul_mat(ctx, vT, kq);                    // [hd, nq, heads, B]
+    kqv = ggml_cont(ctx, ggml_permute(ctx, kqv, 0, 2, 1, 3));        // [hd, heads, nq, B]
+    return ggml_reshape_2d(ctx, kqv, hp.dModel, numQueries * batch);
+}
+
+void MarianModel::encode(const std::vector<std::vector<int>>& src, int srcLen, int threads)
+{
+    const int B = state.batch, S = srcLen, d = hp.dModel, hd = d / hp.nHeads, H = hp.nHeads;
+    const size_t N = (size_t) S * (size_t) B;
+
+    const size_t floats = (size_t) hp.encLayers * (24 * d * N + 3 * (size_t) hp.ffnDim * N + 4 * (size_t) H * S * N)
+                        + (size_t) hp.decLayers * 8 * d * N + 4 * d * N;
+    ggml_context* ctx = newComputeContext(floats * sizeof(float) + (16u << 20));
+    ggml_cgraph* gf = ggml_new_graph_custom(ctx, maxGraphNodes, false);
+
+    ggml_tensor* ids = ggml_new_tensor_1d(ctx, GGML_TYPE_I32, (int64_t) N);
+    auto* idData = static_cast<int32_t*>(ids->data);
+    auto* maskData = static_cast<float*>(state.srcMask->data);
+    for (int b = 0; b < B; ++b)
+        for (int s = 0; s < S; ++s)
+        {
+            const bool real = s < (int) src[(size_t) b].size();
+            idData[b * S + s] = real ? src[(size_t) b][(size_t) s] : hp.pad;
+            maskData[b * S + s] = real ? 0.0f : -INFINITY;
+        }
+
+    ggml_tensor* x = ggml_get_rows(ctx, embed, ids);                 // [d, S*B]
+    if (hp.scaleEmbedding)
+        x = ggml_scale(ctx, x, std::sqrt((float) d));
+    ggml_tensor* pos = ggml_view_2d(ctx, positions, d, S, positions->nb[1], (size_t) hp.posOffset * positions->nb[1]);
+    x = ggml_add(ctx, ggml_reshape_3d(ctx, x, d, S, B), pos);
+    x = ggml_reshape_2d(ctx, x, d, (int64_t) N);
+
+    auto heads = [&] (ggml_tensor* t) { return ggml_reshape_4d(ctx, t, hd, H, S, B); };
+
+    for (const auto& l : enc)
+    {
+        ggml_tensor* h = hp.preNorm ? norm(ctx, x, l.attnLn) : x;
+        ggml_tensor* q  = ggml_permute(ctx, heads(linear(ctx, h, l.attn.q)), 0, 2, 1, 3);
+        ggml_tensor* k  = ggml_permute(ctx, heads(linear(ctx, h, l.attn.k)), 0, 2, 1, 3);
+        ggml_tensor* vT = ggml_cont(ctx, ggml_permute(ctx, heads(linear(ctx, h, l.attn.v)), 1, 2, 0, 3));
+
+        h = linear(ctx, attend(ctx, q, k, vT, state.srcMask, S, B), l.attn.o);
+        x = ggml_add(ctx, x, h);
+        if (! hp.preNorm) x = norm(ctx, x, l.attnLn);
+
+        h = hp.preNorm ? norm(ctx, x, l.ffnLn) : x;
+        h = linear(ctx, activation(ctx, linear(ctx, h, l.fc1)), l.fc2);
+        x = ggml_add(ctx, x, h);
+        if (! hp.preNorm) x = norm(ctx, x, l.ffnLn);
+    }
+    if (hp.preNorm && encLn.w != nullptr)
+        x = norm(ctx, x, encLn);
+
+    // cross-attention keys / values depend only on the source: once per batch
+    for (size_t i = 0; i < dec.size(); ++i)
+    {
+        ggml_tensor* k = ggml_permute(ctx, heads(linear(ctx, x, dec[i].cross.k)), 0, 2, 1, 3);
+        ggml_tensor* v = ggml_permute(ctx, heads(linear(ctx, x, dec[i].cross.v)), 1, 2, 0, 3);
+        ggml_build_forward_expand(gf, ggml_cpy(ctx, k, state.crossK[i]));
+        ggml_build_forward_expand(gf, ggml_cpy(ctx, v, state.crossV[i]));
+    }
+
+    ggml_graph_compute_with_ctx(ctx, gf, threads);
+    ggml_free(ctx);
+}
+
+void MarianModel::decodeStep(const std::vector<int>& tokens, int step, std::vector<int>& next, int threads)
+{
+    const int B = state.batch, d = hp.dModel, hd = d / hp.nHeads, H = hp.nHeads;
+
+    const size_t floats = (size_t) hp.decLayers * ((size_t) 40 * d * B + 4 * (size_t) H * (state.steps + state.srcLen) * B
+                                                   + 3 * (size_t) hp.ffnDim * B)
+                        + 3 * (size_t) hp.vocab * B;
+    ggml_context* ctx = newComputeContext(floats * sizeof(float) + (4u << 20));
+    ggml_cgraph* gf = ggml_new_graph_custom(ctx, maxGraphNodes, false);
+
+    ggml_tensor* ids = ggml_new_tensor_1d(ctx, GGML_TYPE_I32, B);
+    std::copy(tokens.begin(), tokens.end(), static_cast<int32_t*>(ids->data));
+
+    ggml_tensor* x = ggml_get_rows(ctx, embed, ids);                 // [d, B]
+    if (hp.scaleEmbedding)
+        x = ggml_scale(ctx, x, std::sqrt((float) d));
+    x = ggml_add(ctx, x, ggml_view_2d(ctx, positions, d, 1, positions->nb[1], (size_t) (step + hp.posOffset) * positions->nb[1]));
+
+    auto heads = [&] (ggml_tensor* t) { return ggml_reshape_4d(ctx, t, hd, H, 1, B); };
+
+    for (size_t i = 0; i < dec.size(); ++i)
+    {
+        const auto& l = dec[i];
+        ggml_tensor* cacheK = state.selfK[i];
+        ggml_tensor* cacheV = state.selfV[i];
+
+        // self-attention: append this step's key / value, attend over 0..step
+        ggml_tensor* h = hp.preNorm ? norm(ctx, x, l.attnLn) : x;
+        ggml_tensor* q = ggml_permute(ctx, heads(linear(ctx, h, l.attn.q)), 0, 2, 1, 3);
+        ggml_tensor* k = ggml_permute(ctx, heads(linear(ctx, h, l.attn.k)), 0, 2, 1, 3);
+        ggml_tensor* v = ggml_permute(ctx, heads(linear(ctx, h, l.attn.v)), 1, 2, 0, 3);
+
+        ggml_build_forward_expand(gf, ggml_cpy(ctx, k, ggml_view_4d(ctx, cacheK, hd, 1, H, B, cacheK->nb[1], cacheK->nb[2], cacheK->nb[3],
+                                                                    (size_t) step * cacheK->nb[1])));
+        ggml_build_forward_expand(gf, ggml_cpy(ctx, v, ggml_view_4d(ctx, cacheV, 1, hd, H, B, cacheV->nb[1], cacheV->nb[2], cacheV->nb[3],
+                                                                    (size_t) step * cacheV->nb[0])));
+
+        ggml_tensor* keys = ggml_view_4d(ctx, cacheK, hd, step + 1, H, B, cacheK->nb[1], cacheK->nb[2], cacheK->nb[3], 0);
+        ggml_tensor* valuesT = ggml_view_4d(ctx, cacheV, step + 1, hd, H, B, cacheV->nb[1], cacheV->nb[2], cacheV->nb[3], 0);
+
+        h = linear(ctx, attend(ctx, q, keys, valuesT, nullptr, 1, B), l.attn.o);
+        x = ggml_add(ctx, x, h);
+        if (! hp.preNorm) x = norm(ctx, x, l.attnLn);
+
+        // cross-attention over the encoder output
+        h = hp.preNorm ? norm(ctx, x, l.crossLn) : x;
+        q = ggml_permute(ctx, heads(linear(ctx, h, l.cross.q)), 0, 2, 1, 3);
+        h = linear(ctx, attend(ctx, q, state.crossK[i], state.crossV[i], state.srcMask, 1, B), l.cross.o);
+        x = ggml_add(ctx, x, h);
+        if (! hp.preNorm) x = norm(ctx, x, l.crossLn);
+
+        h = hp.preNorm ? norm(ctx, x, l.ffnLn) : x;
+        h = linear(ctx, activation(ctx, linear(ctx, h, l.fc1)), l.fc2);
+        x = ggml_add(ctx, x, h);
+        if (! hp.preNorm) x = norm(ctx, x, l.ffnLn);
+    }
+    if (hp.preNorm && decLn.w != nullptr)
+        x = norm(ctx, x, decLn);
+
+    ggml_tensor* logits = ggml_add(ctx, ggml_mul_mat(ctx, lmHead, x), outputBias); // [vocab, B]
+    ggml_tensor* best = ggml_argmax(ctx, logits);
+    ggml_build_forward_expand(gf, best);
+
+    ggml_graph_compute_with_ctx(ctx, gf, threads);
+
+    const auto* bestData = static_cast<const int32_t*>(best->data);
+    next.assign(bestData, bestData + B);
+    ggml_free(ctx);
+}
+
+std::vector<std::string> MarianModel::translate(const std::vector<std::string>& sentences, int threads)
+{
+    std::vector<std::string> results(sentences.size());
+    if (sentences.empty())
+        return results;
+
+    std::lock_guard<std::mutex> lg(mx);
+
+    // source ids: [lang tag] pieces </s>
+    std::vector<std::vector<int>> src;
+    src.reserve(sentences.size());
+    int srcLen = 1;
+    for (const auto& s : sentences)
+    {
+        std::vector<int> ids;
+        if (hp.srcPrefix >= 0)
+            ids.push_back(hp.srcPrefix);
+        auto pieces = tokenizer.encode(s);
+        pieces.resize(std::min(pieces.size(), (size_t) std::max(0, hp.maxLen - 2)));
+        ids.insert(ids.end(), pieces.begin(), pieces.end());
+        ids.push_back(hp.eos);
+        srcLen = std::max(srcLen, (int) ids.size());
+        src.push_back(std::move(ids));
+    }
+
+    const int batch = (int) sentences.size();
+    const int steps = std::min(hp.maxLen, srcLen * 2 + 16); // output budget; also sizes the KV cache
+    beginBatch(batch, srcLen, steps);
+    encode(src, srcLen, threads);
+
+    std::vector<std::vector<int>> out((size_t) batch);
+    std::vector<int> tokens((size_t) batch, hp.decoderStart), next;
+    std::vector<bool> done((size_t) batch, false);
+    int remaining = batch;
+
+    for (int step = 0; step < steps && remaining > 0; ++step)
+    {
+        decodeStep(tokens, step, next, threads);
+
+        for (size_t b = 0; b < (size_t) batch; ++b)
+        {
+            if (done[b])
+            {
+                tokens[b] = hp.pad;
+                continue;
+            }
+
+            const int id = step == 0 && hp.forcedBos >= 0 ? hp.forcedBos : next[b];
+            if (id == hp.eos)
+            {
+                done[b] = true;
+                tokens[b] = hp.pad;
+                --remaining;
+                continue;
+            }
+            out[b].push_back(id);
+            tokens[b] = id;
+        }
+    }
+
+    for (size_t b = 0; b < (size_t) batch; ++b)
+        results[b] = tokenizer.decode(out[b]);
+    return results;
+}
@@ -0,0 +1,114 @@
+#pragma once
+#include <memory>
+#include <mutex>
+#include <string>
+#include <vector>
+#include <juce_core/juce_core.h>
+#include "UnigramTokenizer.h"
+
+struct ggml_context;
+struct ggml_tensor;
+
+// Transformer encoder-decoder MT model (MarianMT / opus-mt, and pre-norm
+// NLLB/M2M-style checkpoints) running on the CPU through ggml, the same
+// runtime whisper uses. Weights come from a GGUF file that is memory-mapped
+// and used in place, so any quantisation ggml supports (q8_0, q5_1, ...)
+// works and several instances can share the pages.
+//
+// GGUF layout (written by Tools/convert-opus-mt.py):
+//   marian.d_model / n_heads / encoder_layers / decoder_layers / ffn_dim / max_len   u32
+//   marian.pre_norm, marian.scale_embedding                                       bool
+//   marian.activation ("swish" | "relu" | "gelu"), marian.pos_offset (u32)
+//   tokenizer.ggml.tokens / scores, tokenizer.eos_id / pad_id / unk_id / decoder_start_id
+//   tokenizer.src_prefix_id, tokenizer.forced_bos_id (i32, -1 = none; NLLB language tags)
+//   embed_tokens.weight [d, vocab] (tied with the output projection), final_logits_bias [vocab]
+//   {enc|dec}.N.attn.{q,k,v,o}.{w,b}  {enc|dec}.N.attn_ln.{w,b}
+//   dec.N.cross.{q,k,v,o}.{w,b}       dec.N.cross_ln.{w,b}
+//   {enc|dec}.N.fc1.{w,b} / fc2.{w,b} {enc|dec}.N.ffn_ln.{w,b}
+//   enc.ln.{w,b}, dec.ln.{w,b}         (pre-norm models only), lm_head.weight (untied only)
+class MarianModel
+{
+public:
+    struct HParams
+    {
+        int dModel = 512, nHeads = 8, encLayers = 6, decLayers = 6, ffnDim = 2048, maxLen = 512;
+        int vocab = 0, posOffset = 0;
+        bool preNorm = false, scaleEmbedding = true;
+        enum class Activation { swish, relu, gelu } activation = Activation::swish;
+        int eos = 0, pad = 0, unk = 1, decoderStart = 0, srcPrefix = -1, forcedBos = -1;
+    };
+
+    // nullptr (and a reason in 'error') if the file isn't a usable model
+    static std::unique_ptr<MarianModel> load(const juce::File& file, juce::String& error);
+    ~MarianModel();
+
+    // Greedy-decodes all sentences as one batch; one result per input
+    std::vector<std::string> translate(const std::vector<std::string>& sentences, int threads);
+
+    const HParams& getHParams() const { return hp; }
+
+private:
+    struct Linear { ggml_tensor* w = nullptr; ggml_tensor* b = nullptr; };
+    struct Norm   { ggml_tensor* w = nullptr; ggml_tensor* b = nullptr; };
+
+    struct Attention { Linear q, k, v, o; };
+
+    struct EncoderLayer
+    {
+        Attention attn;
+        Norm attnLn, ffnLn;
+        Linear fc1, fc2;
+    };
+
+    struct DecoderLayer
+    {
+        Attention attn, cross;
+        Norm attnLn, crossLn, ffnLn;
+        Linear fc1, fc2;
+    };
+
+    // per-batch state: decoder self-attention KV cache, cross-attention K/V
+    // and the source padding mask; lives in 'stateBuffer', which is reused
+    struct BatchState
+    {
+        ggml_context* ctx = nullptr;
+        int batch = 0, srcLen = 0, steps = 0;
+        std::vector<ggml_tensor*> selfK, selfV, crossK, crossV; // V stored transposed
+        ggml_tensor* srcMask = nullptr;
+    };
+
+    MarianModel() = default;
+
+    bool bindTensors(juce::String& error);
+    void buildConstants();
+    void beginBatch(int batch, int srcLen, int steps);
+
+    void encode(const std::vector<std::vector<int>>& src, int srcLen, int threads);
+    void decodeStep(const std::vector<int>& tokens, int step, std::vector<int>& next, int threads);
+
+    ggml_context* newComputeContext(size_t bytes);
+    ggml_tensor* linear(ggml_context* ctx, ggml_tensor* x, const Linear& l) const;
+    ggml_tensor* norm(ggml_context* ctx, ggml_tensor* x, const Norm& n) const;
+    ggml_tensor* activation(ggml_context* ctx, ggml_tensor* x) const;
+    ggml_tensor* attend(ggml_context* ctx, ggml_tensor* q, ggml_tensor* k, ggml_tensor* vT,
+                        ggml_tensor* mask, int numQueries, int batch) const;
+
+    HParams hp;
+    UnigramTokenizer tokenizer;
+
+    std::unique_ptr<juce::MemoryMappedFile> mapped;
+    ggml_context* weights = nullptr;   // tensor metadata; data points into 'mapped'
+    ggml_context* constants = nullptr; // positional table, output bias
+
+    ggml_tensor* embed = nullptr;
+    ggml_tensor* lmHead = nullptr;     // embed unless the file has its own
+    ggml_tensor* positions = nullptr;  // [d, maxLen + posOffset]
+    ggml_tensor* outputBias = nullptr; // final_logits_bias, pad suppressed
+    std::vector<EncoderLayer> enc;
+    std::vector<DecoderLayer> dec;
+    Norm encLn, decLn;
+
+    std::mutex mx;                     // one batch at a time per model
+    BatchState state;
+    std::vector<uint8_t> stateBuffer, computeBuffer;
+};
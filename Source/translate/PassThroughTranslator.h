@@ -7,4 +7,12 @@ public:
         // Simple identity; replace with DeepL/Cloud call later
         return r.text;
     }
+
+    // the input back is never a translation
+    std::vector<TranslateResult> tryTranslateBatch(const std::vector<TranslateRequest>& batch) override {
+        std::vector<TranslateResult> out;
+        for (const auto& r : batch)
+            out.push_back({ r.text, false });
+        return out;
+    }
 };
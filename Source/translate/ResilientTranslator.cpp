@@ -0,0 +1,180 @@
+#include "ResilientTranslator.h"
+#include <algorithm>
+#include <condition_variable>
+#include <mutex>
+
+// Shared between the waiting caller and every attempt still running
+struct ResilientTranslator::Call
+{
+    std::vector<TranslateRequest> requests;
+
+    std::mutex mx;
+    std::condition_variable cv;
+    int running = 0;
+    int winner = -1;          // attempt whose answer was used
+    std::vector<TranslateResult> results;
+};
+
+ResilientTranslator::ResilientTranslator(ITranslator& p, ITranslator& f, const Config& c)
+: primary(p), fallback(f), config(c), breaker(c.failureThreshold, c.coolDownMs)
+{
+}
+
+ResilientTranslator::~ResilientTranslator()
+{
+    // abandoned requests still reference the backend; let them run out
+    pool.removeAllJobs(true, 15000);
+}
+
+void ResilientTranslator::launch(const std::shared_ptr<Call>& call, int attempt)
+{
+    {
+        std::lock_guard<std::mutex> lg(call->mx);
+        ++call->running;
+    }
+
+    pool.addJob([this, call, attempt]
+    {
+        const double t0 = juce::Time::getMillisecondCounterHiRes();
+        auto out = primary.tryTranslateBatch(call->requests);
+
+        // an attempt answers when it got at least one segment through;
+        // the rest of its batch falls back individually
+        bool ok = out.size() == call->requests.size();
+        bool any = false;
+        for (size_t i = 0; ok && i < out.size(); ++i)
+            any |= out[i].ok && ! out[i].text.empty();
+        ok &= any;
+
+        // late answers still count towards the backend's latency profile
+        if (ok)
+            latency.add(juce::Time::getMillisecondCounterHiRes() - t0);
+
+        std::lock_guard<std::mutex> lg(call->mx);
+        --call->running;
+        if (ok && call->winner < 0)
+        {
+            call->winner = attempt;
+            call->results = std::move(out);
+        }
+        call->cv.notify_all();
+    });
+}
+
+std::string ResilientTranslator::translate(const TranslateRequest& r)
+{
+    return run({ r }).front().text;
+}
+
+std::vector<TranslateResult> ResilientTranslator::tryTranslateBatch(const std::vector<TranslateRequest>& batch)
+{
+    return run(batch);
+}
+
+std::vector<TranslateResult> ResilientTranslator::run(const std::vector<TranslateRequest>& batch)
+{
+    calls += batch.size();
+    std::vector<TranslateResult> out(batch.size());
+
+    // empty text needs no backend; the rest goes out together
+    auto call = std::make_shared<Call>();
+    std::vector<size_t> slots;
+    int budget = 0;
+    for (size_t i = 0; i < batch.size(); ++i)
+    {
+        if (batch[i].text.empty())
+        {
+            out[i] = { batch[i].text, true };
+            continue;
+        }
+        slots.push_back(i);
+        budget = std::max(budget, batch[i].budgetMs > 0 ? batch[i].budgetMs : config.budgetMs);
+        call->requests.push_back(batch[i]);
+    }
+    if (slots.empty())
+        return out;
+
+    const auto fallBack = [&](size_t slot) {
+        ++fallbacks;
+        out[slot] = fallback.tryTranslate(batch[slot]);
+    };
+
+    if (! breaker.allow())
+    {
+        for (size_t slot : slots)
+            fallBack(slot);
+        return out;
+    }
+
+    for (auto& r : call->requests)
+        r.budgetMs = budget; // backends size their own timeouts from it
+
+    using namespace std::chrono;
+    const auto deadline = steady_clock::now() + milliseconds(budget);
+    const auto settled = [&call] { return call->winner >= 0 || call->running == 0; };
+
+    launch(call, 0);
+
+    std::unique_lock<std::mutex> lk(call->mx);
+
+    // hedge: the first attempt is slower than this backend usually is
+    const double p95 = latency.p95();
+    if (config.hedge && p95 > 0.0 && p95 < budget)
+    {
+        if (! call->cv.wait_until(lk, steady_clock::now() + milliseconds((int) p95), settled))
+        {
+            ++hedges;
+            lk.unlock();
+            launch(call, 1);
+            lk.lock();
+        }
+    }
+
+    call->cv.wait_until(lk, deadline, settled);
+
+    if (call->winner >= 0)
+    {
+        if (call->winner == 1) ++hedgeWins;
+        auto results = call->results;
+        lk.unlock();
+
+        bool allOk = true;
+        for (size_t k = 0; k < slots.size(); ++k)
+        {
+            if (results[k].ok && ! results[k].text.empty())
+                out[slots[k]] = { std::move(results[k].text), true };
+            else
+            {
+                allOk = false;
+                fallBack(slots[k]);
+            }
+        }
+        if (allOk)
+            breaker.onSuccess();
+        else
+            breaker.onFailure();
+        return out;
+    }
+
+    if (call->running > 0) ++timeouts;
+    call->winner = 2; // anything arriving later is discarded
+    lk.unlock();
+
+    breaker.onFailure();
+    for (size_t slot : slots)
+        fallBack(slot);
+    return out;
+}
+
+ResilientTranslator::Stats ResilientTranslator::getStats() const
+{
+    Stats s;
+    s.calls = calls.load();
+    s.fallbacks = fallbacks.load();
+    s.timeouts = timeouts.load();
+    s.hedges = hedges.load();
+    s.hedgeWins = hedgeWins.load();
+    s.breakerTrips = breaker.getTrips();
+    s.p95Ms = latency.p95();
+    return s;
+}
@@ -0,0 +1,61 @@
+#pragma once
+#include <atomic>
+#include <memory>
+#include <juce_core/juce_core.h>
+#include "ITranslator.h"
+#include "../net/CircuitBreaker.h"
+#include "../net/LatencyTracker.h"
+
+// Puts a deadline, a circuit breaker and optional hedging in front of a
+// network translator. A call that misses its budget (or that the breaker
+// skips) is answered by the fallback instead, e.g. PassThroughTranslator;
+// the abandoned request finishes in the background and is ignored. With
+// hedging on, a second identical request goes out once the first has taken
+// longer than the backend's recent p95, and whichever answers first wins.
+// Failure is what the backend reports through tryTranslateBatch(); an
+// answer that reads the same as the input is still a good one. A batch goes
+// to the backend as one call under one deadline (the longest budget in it),
+// so a batching backend below still sees the segments together; segments
+// it fails on get the fallback's answer.
+class ResilientTranslator : public ITranslator
+{
+public:
+    struct Config
+    {
+        int budgetMs = 1500;        // used when the request doesn't carry one
+        bool hedge = true;
+        int failureThreshold = 3;
+        double coolDownMs = 10000.0;
+    };
+
+    struct Stats
+    {
+        uint64_t calls = 0, fallbacks = 0, timeouts = 0, hedges = 0, hedgeWins = 0;
+        int breakerTrips = 0;
+        double p95Ms = -1.0;
+    };
+
+    ResilientTranslator(ITranslator& primary, ITranslator& fallback, const Config& config);
+    ResilientTranslator(ITranslator& primary, ITranslator& fallback) : ResilientTranslator(primary, fallback, Config {}) {}
+    ~ResilientTranslator() override;
+
+    std::string translate(const TranslateRequest& r) override;
+    std::vector<TranslateResult> tryTranslateBatch(const std::vector<TranslateRequest>& batch) override; // not ok = fallback's answer
+
+    Stats getStats() const;
+
+private:
+    struct Call;
+    void launch(const std::shared_ptr<Call>& call, int attempt);
+    std::vector<TranslateResult> run(const std::vector<TranslateRequest>& batch);
+
+    ITranslator& primary;
+    ITranslator& fallback;
+    const Config config;
+
+    CircuitBreaker breaker;
+    LatencyTracker latency;
+    juce::ThreadPool pool { 4 };  // primary calls, so they can be abandoned
+
+    std::atomic<uint64_t> calls { 0 }, fallbacks { 0 }, timeouts { 0 }, hedges { 0 }, hedgeWins { 0 };
+};
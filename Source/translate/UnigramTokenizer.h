@@ -0,0 +1,157 @@
+#pragma once
+#include <algorithm>
+#include <cstdint>
+#include <limits>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+// SentencePiece unigram tokenizer over a vocabulary read from the model file
+// (pieces + log-probability scores). Encoding is the usual Viterbi search
+// for the highest-scoring segmentation; spaces are the "▁" meta symbol and
+// characters no piece covers map to unk. Good enough for MT inputs, which
+// are already NFKC-normalised by the time whisper hands them over.
+class UnigramTokenizer
+{
+public:
+    void load(std::vector<std::string> pieces, std::vector<float> scores, int unk)
+    {
+        vocab = std::move(pieces);
+        unkId = unk;
+        lookup.clear();
+        lookup.reserve(vocab.size());
+        maxPieceBytes = 1;
+        minScore = 0.0f;
+
+        for (size_t i = 0; i < vocab.size(); ++i)
+        {
+            const float s = i < scores.size() ? scores[i] : 0.0f;
+            lookup.emplace(vocab[i], Entry { (int) i, s });
+            maxPieceBytes = std::max(maxPieceBytes, vocab[i].size());
+            minScore = std::min(minScore, s);
+        }
+    }
+
+    bool isLoaded() const { return ! vocab.empty(); }
+    size_t size() const   { return vocab.size(); }
+
+    std::vector<int> encode(const std::string& text) const
+    {
+        const std::string s = normalise(text);
+        const size_t n = s.size();
+
+        // best[i]: best score of a segmentation of s[0, i)
+        std::vector<float> best(n + 1, -std::numeric_limits<float>::infinity());
+        std::vector<int> fromPos(n + 1, -1), fromId(n + 1, -1);
+        best[0] = 0.0f;
+
+        for (size_t i = 0; i < n; ++i)
+        {
+            if (best[i] == -std::numeric_limits<float>::infinity() || ! isCharStart(s, i))
+                continue;
+
+            bool any = false;
+            for (size_t len = 1; len <= maxPieceBytes && i + len <= n; ++len)
+            {
+                if (i + len < n && ! isCharStart(s, i + len))
+                    continue;
+                auto it = lookup.find(s.substr(i, len));
+                if (it == lookup.end())
+                    continue;
+
+                any = true;
+                const float score = best[i] + it->second.score;
+                if (score > best[i + len])
+                {
+                    best[i + len] = score;
+                    fromPos[i + len] = (int) i;
+                    fromId[i + len] = it->second.id;
+                }
+            }
+
+            // nothing covers this character: consume it as unk
+            if (! any)
+            {
+                const size_t len = charLength(s, i);
+                const float score = best[i] + minScore - 10.0f;
+                if (score > best[i + len])
+                {
+                    best[i + len] = score;
+                    fromPos[i + len] = (int) i;
+                    fromId[i + len] = unkId;
+                }
+            }
+        }
+
+        std::vector<int> ids;
+        for (int pos = (int) n; pos > 0; pos = fromPos[(size_t) pos])
+            ids.push_back(fromId[(size_t) pos]);
+        std::reverse(ids.begin(), ids.end());
+
+        // merge runs of unk, as sentencepiece does
+        ids.erase(std::unique(ids.begin(), ids.end(), [this] (int a, int b) { return a == unkId && b == unkId; }), ids.end());
+        return ids;
+    }
+
+    std::string decode(const std::vector<int>& ids) const
+    {
+        std::string out;
+        for (int id : ids)
+            if (id >= 0 && (size_t) id < vocab.size() && ! isControl(vocab[(size_t) id]))
+                out += vocab[(size_t) id];
+
+        // "▁" back to spaces
+        std::string text;
+        text.reserve(out.size());
+        for (size_t i = 0; i < out.size();)
+        {
+            if (out.compare(i, 3, space) == 0) { text += ' '; i += 3; }
+            else                               { text += out[i++]; }
+        }
+        const auto first = text.find_first_not_of(' ');
+        return first == std::string::npos ? std::string() : text.substr(first);
+    }
+
+private:
+    struct Entry
+    {
+        int id;
+        float score;
+    };
+
+    static constexpr const char* space = "\xe2\x96\x81"; // U+2581
+
+    static bool isCharStart(const std::string& s, size_t i) { return ((unsigned char) s[i] & 0xc0) != 0x80; }
+
+    static size_t charLength(const std::string& s, size_t i)
+    {
+        size_t len = 1;
+        while (i + len < s.size() && ! isCharStart(s, i + len)) ++len;
+        return len;
+    }
+
+    static bool isControl(const std::string& piece)
+    {
+        return piece.size() > 2 && piece.front() == '<' && piece.back() == '>'; // <pad>, </s>, <unk>, language tags
+    }
+
+    // collapse whitespace, prefix a space, spaces -> "▁"
+    static std::string normalise(const std::string& text)
+    {
+        std::string out;
+        bool pendingSpace = true;
+        for (char c : text)
+        {
+            if (c == ' ' || c == '\t' || c == '\n' || c == '\r') { pendingSpace = true; continue; }
+            if (pendingSpace) { out += space; pendingSpace = false; }
+            out += c;
+        }
+        return out;
+    }
+
+    std::vector<std::string> vocab;
+    std::unordered_map<std::string, Entry> lookup;
+    size_t maxPieceBytes = 1;
+    float minScore = 0.0f;
+    int unkId = 1;
+};
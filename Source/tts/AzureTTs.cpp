@@ -1,5 +1,6 @@
 #include "AzureTTS.h"
-#include <juce_audio_formats/juce_audio_formats.h>
+#include "../net/HttpClient.h"
+#include "WavStreamParser.h"
 
 // -------- Voice selection helper ----------
 static AzureVoiceProfile pickDefaultVoice(const juce::String& lang,
@@ -53,12 +54,31 @@ AzureVoiceProfile AzureTTS::pickVoice(const juce::String& lang,
 juce::String AzureTTS::buildSsml(const juce::String& text,
     const AzureVoiceProfile& v) const
 {
-    return "<speak version='1.0' xml:lang='en-US'>"
-        "<voice name='" + v.name + "'>"
-        + juce::String(text).replace("&", "&amp;")
+    const auto escaped = juce::String(text).replace("&", "&amp;")
         .replace("<", "&lt;")
-        .replace(">", "&gt;")
-        + "</voice></speak>";
+        .replace(">", "&gt;");
+
+    // the locale is the voice name's prefix ("de-CH-LeniNeural" -> "de-CH");
+    // a style the voice doesn't have is ignored by the service
+    const auto locale = v.name.upToLastOccurrenceOf("-", false, false);
+    const auto body = v.style.isEmpty()
+        ? escaped
+        : "<mstts:express-as style='" + v.style.toLowerCase() + "'>" + escaped + "</mstts:express-as>";
+
+    return "<speak version='1.0' xmlns='http://www.w3.org/2001/10/synthesis'"
+        " xmlns:mstts='https://www.w3.org/2001/mstts' xml:lang='" + locale + "'>"
+        "<voice name='" + v.name + "'>" + body + "</voice></speak>";
+}
+
+juce::String AzureTTS::endpoint() const
+{
+    return "https://" + azureRegion + ".tts.speech.microsoft.com/cognitiveservices/v1";
+}
+
+void AzureTTS::prewarm()
+{
+    if (azureKey.isNotEmpty() && azureRegion.isNotEmpty())
+        HttpClient::shared().prewarm(endpoint());
 }
 
 // --------- Main synthesize() override ----------
@@ -72,53 +92,34 @@ void AzureTTS::synthesize(const TtsRequest& req,
     }
 
     AzureVoiceProfile voice = pickDefaultVoice("en", "Female");
+    if (! req.voice.empty())
+        voice.name = juce::String(req.voice);
+    voice.style = juce::String(req.style); // only an explicitly requested style goes into the SSML
     juce::String ssml = buildSsml(req.text, voice);
 
-    juce::URL url("https://" + azureRegion + ".tts.speech.microsoft.com/cognitiveservices/v1");
-
-    // ✅ Build header string manually (old JUCE API requirement)
-    juce::String headerString;
-    headerString << "Ocp-Apim-Subscription-Key: " << azureKey << "\r\n";
-    headerString << "Content-Type: application/ssml+xml\r\n";
-    headerString << "X-Microsoft-OutputFormat: riff-16000hz-16bit-mono-pcm\r\n";
-
-    // ✅ Use old JUCE createInputStream() signature
-    std::unique_ptr<juce::InputStream> stream(
-        url.withPOSTData(ssml)
-        .createInputStream(true,           // use POST
-            nullptr,         // no progress callback
-            nullptr,         // no context
-            headerString,    // ✅ MUST be juce::String, not StringPairArray
-            0)               // no timeout
-    );
-
-    if (!stream)
-    {
-        onChunk({}, true);
-        return;
-    }
-
-    juce::MemoryBlock wavData;
-    stream->readIntoMemoryBlock(wavData);
-
-    juce::MemoryInputStream mis(wavData, false);
-    juce::WavAudioFormat fmt;
-    auto reader = std::unique_ptr<juce::AudioFormatReader>(fmt.createReaderFor(&mis, true));
-
-    if (!reader)
-    {
-        onChunk({}, true);
-        return;
-    }
-
-    int N = (int)reader->lengthInSamples;
-    juce::AudioBuffer<float> buffer(1, N);
-    reader->read(&buffer, 0, N, 0, true, false);
-
-    std::vector<float> pcm(N);
-    memcpy(pcm.data(), buffer.getReadPointer(0), N * sizeof(float));
-
-    onChunk(pcm, true);
+    HttpRequest request;
+    request.url = endpoint();
+    // the budget is time-to-first-audio; the whole stream may take longer
+    request.timeoutMs = std::max(10000, 4 * req.budgetMs);
+    request.headers.set("Ocp-Apim-Subscription-Key", azureKey);
+    request.headers.set("Content-Type", "application/ssml+xml");
+    request.headers.set("X-Microsoft-OutputFormat", juce::String(req.format));
+    request.body.append(ssml.toRawUTF8(), ssml.getNumBytesAsUTF8());
+
+    // PCM goes out in fixed-size chunks as the body downloads, so playback
+    // starts with the first chunk rather than after the whole utterance
+    WavStreamParser parser(chunkSamples, [&onChunk](const std::vector<float>& pcm) { onChunk(pcm, false); });
+
+    // pooled keep-alive connection: no new TCP/TLS handshake per utterance
+    const auto response = HttpClient::shared().send(request, [&parser](const void* data, size_t size) {
+        return parser.feed(data, size); // not a usable WAV (e.g. an error page): stop downloading
+    });
+
+    // whatever arrived before a failure mid-stream has already been played;
+    // the tail goes with eof. A transport "OK" on a body that stopped short
+    // of the WAV's declared length is still a cut-off: empty eof, so it's
+    // neither counted as a success nor cached.
+    onChunk(response.ok() && parser.complete() ? parser.takeRemainder() : std::vector<float> {}, true);
 }
 
 
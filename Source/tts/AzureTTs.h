@@ -22,13 +22,20 @@ public:
                                 const juce::String& gender,
                                 const juce::String& style) const;
 
+    // Opens a pooled connection to the region's endpoint ahead of the first request
+    void prewarm();
+
     // STREAMING callback:
     void synthesize(const TtsRequest& req,
         std::function<void(const std::vector<float>&, bool)> onChunk) override;
 
 private:
+    static constexpr size_t chunkSamples = 1600; // 100 ms at 16 kHz per streamed chunk
+
     juce::String azureKey, azureRegion;
 
+    juce::String endpoint() const;
+
     juce::String buildSsml(const juce::String& text,
                            const AzureVoiceProfile& voice) const;
 };
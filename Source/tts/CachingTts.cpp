@@ -0,0 +1,383 @@
+#include "CachingTts.h"
+#include <algorithm>
+#include <cmath>
+#include <cstring>
+
+// One file per entry, named after the key's hash: a small header, the key
+// (to tell hash collisions apart) and the samples as 16-bit PCM, which is
+// what the backend sent and half the size of float. Files are written
+// to a temporary and moved into place, so a crash never leaves a half entry
+// under a real name. The LRU order is the files' modification times, which
+// survive restarts; a hit bumps the time.
+class CachingTts::DiskStore
+{
+public:
+    struct Mapped
+    {
+        std::unique_ptr<juce::MemoryMappedFile> map;
+        const int16_t* samples = nullptr;
+        size_t numSamples = 0;
+    };
+
+    DiskStore(const juce::File& d, uint64_t budgetBytes) : dir(d), budget(budgetBytes)
+    {
+        dir.createDirectory();
+
+        juce::Array<juce::File> files;
+        for (const auto& f : dir.findChildFiles(juce::File::findFiles, false, "*"))
+        {
+            if (f.hasFileExtension("pcm") && f.getFileNameWithoutExtension().length() == 16)
+                files.add(f);
+            else
+                f.deleteFile(); // temporaries left by a crash mid-write
+        }
+
+        std::sort(files.begin(), files.end(), [](const juce::File& a, const juce::File& b) {
+            return a.getLastModificationTime() > b.getLastModificationTime();
+        });
+
+        for (const auto& f : files)
+        {
+            const uint64_t h = (uint64_t) f.getFileNameWithoutExtension().getHexValue64();
+            lru.push_back({ h, (uint64_t) f.getSize() });
+            index[h] = std::prev(lru.end());
+            used += lru.back().bytes;
+        }
+
+        for (const auto& f : evict())
+            f.deleteFile();
+    }
+
+    bool isValid() const { return dir.isDirectory(); }
+
+    // Maps the entry for key; false if there is none (or it's damaged)
+    bool open(const std::string& key, Mapped& out)
+    {
+        const uint64_t h = hash(key);
+        {
+            std::lock_guard<std::mutex> lg(mx);
+            if (index.find(h) == index.end())
+                return false;
+        }
+
+        const auto file = fileFor(h);
+        out.map = std::make_unique<juce::MemoryMappedFile>(file, juce::MemoryMappedFile::readOnly);
+        const auto* base = static_cast<const char*>(out.map->getData());
+        const size_t size = out.map->getSize();
+
+        Header hd {};
+        if (base != nullptr && size >= sizeof(Header))
+            std::memcpy(&hd, base, sizeof(Header));
+
+        const size_t offset = samplesOffset(hd.keyLen);
+        if (std::memcmp(hd.magic, expectedMagic, 4) != 0 || hd.version != version
+            || hd.sampleRate != sampleRate || hd.numSamples == 0 || offset + hd.numSamples * 2 != size)
+        {
+            out.map.reset(); // unmapped first, or Windows won't delete it
+            return drop(h, file);
+        }
+
+        if (hd.keyLen != key.size() || std::memcmp(base + sizeof(Header), key.data(), key.size()) != 0)
+        {
+            out.map.reset();
+            return false; // another key with the same hash
+        }
+
+        out.samples = reinterpret_cast<const int16_t*>(base + offset);
+        out.numSamples = (size_t) hd.numSamples;
+        touch(h);
+        return true;
+    }
+
+    void store(const std::string& key, const Pcm& pcm)
+    {
+        const uint64_t h = hash(key);
+        const auto target = fileFor(h);
+
+        const Header hd { { expectedMagic[0], expectedMagic[1], expectedMagic[2], expectedMagic[3] },
+                          version, sampleRate, (uint32_t) key.size(), (uint64_t) pcm.size() };
+        const size_t pad = samplesOffset(hd.keyLen) - sizeof(Header) - key.size();
+
+        juce::TemporaryFile temp(target);
+        {
+            juce::FileOutputStream out(temp.getFile());
+            if (! out.openedOk())
+                return;
+            const char zero = 0;
+            out.write(&hd, sizeof(Header));
+            out.write(key.data(), key.size());
+            out.write(&zero, pad);
+            out.write(pcm.data(), pcm.size() * sizeof(int16_t));
+            out.flush();
+            if (out.getStatus().failed())
+                return;
+        }
+        if (! temp.overwriteTargetFileWithTemporary())
+            return;
+
+        std::vector<juce::File> victims;
+        {
+            std::lock_guard<std::mutex> lg(mx);
+            const uint64_t bytes = (uint64_t) target.getSize();
+            auto it = index.find(h);
+            if (it != index.end())
+            {
+                used -= it->second->bytes;
+                lru.erase(it->second);
+            }
+            lru.push_front({ h, bytes });
+            index[h] = lru.begin();
+            used += bytes;
+            victims = evictLocked();
+        }
+        for (const auto& f : victims)
+            f.deleteFile();
+    }
+
+    // A memory hit still counts as use of the spilled copy
+    void touch(const std::string& key) { touch(hash(key)); }
+
+    uint64_t bytesUsed() const
+    {
+        std::lock_guard<std::mutex> lg(mx);
+        return used;
+    }
+
+private:
+    struct Header
+    {
+        char magic[4];
+        uint32_t version, sampleRate, keyLen;
+        uint64_t numSamples;
+    };
+
+    struct FileEntry
+    {
+        uint64_t hash, bytes;
+    };
+
+    static constexpr char expectedMagic[4] = { 'L', 'T', 'T', 'S' };
+    static constexpr uint32_t version = 1;
+    static constexpr uint32_t sampleRate = 16000;
+
+    // samples start 2-byte aligned after the key
+    static size_t samplesOffset(uint32_t keyLen) { return sizeof(Header) + keyLen + (keyLen & 1u); }
+
+    static uint64_t hash(const std::string& key)
+    {
+        uint64_t h = 14695981039346656037ull; // FNV-1a
+        for (unsigned char c : key)
+            h = (h ^ c) * 1099511628211ull;
+        return h;
+    }
+
+    juce::File fileFor(uint64_t h) const
+    {
+        return dir.getChildFile(juce::String::toHexString((juce::int64) h).paddedLeft('0', 16) + ".pcm");
+    }
+
+    void touch(uint64_t h)
+    {
+        {
+            std::lock_guard<std::mutex> lg(mx);
+            auto it = index.find(h);
+            if (it == index.end())
+                return;
+            lru.splice(lru.begin(), lru, it->second);
+        }
+        fileFor(h).setLastModificationTime(juce::Time::getCurrentTime());
+    }
+
+    bool drop(uint64_t h, const juce::File& file)
+    {
+        {
+            std::lock_guard<std::mutex> lg(mx);
+            auto it = index.find(h);
+            if (it != index.end())
+            {
+                used -= it->second->bytes;
+                lru.erase(it->second);
+                index.erase(it);
+            }
+        }
+        file.deleteFile();
+        return false;
+    }
+
+    std::vector<juce::File> evict()
+    {
+        std::lock_guard<std::mutex> lg(mx);
+        return evictLocked();
+    }
+
+    // Files to delete once mx is released
+    std::vector<juce::File> evictLocked()
+    {
+        std::vector<juce::File> victims;
+        while (used > budget && ! lru.empty())
+        {
+            const auto& oldest = lru.back();
+            victims.push_back(fileFor(oldest.hash));
+            used -= oldest.bytes;
+            index.erase(oldest.hash);
+            lru.pop_back();
+        }
+        return victims;
+    }
+
+    const juce::File dir;
+    const uint64_t budget;
+
+    mutable std::mutex mx;
+    std::list<FileEntry> lru;               // most recent first
+    std::unordered_map<uint64_t, std::list<FileEntry>::iterator> index;
+    uint64_t used = 0;
+};
+
+CachingTts::CachingTts(ITts& wrapped, const juce::File& storeDir, const Config& c)
+: inner(wrapped), config(c)
+{
+    if (storeDir != juce::File() && config.diskBytes > 0)
+    {
+        disk = std::make_unique<DiskStore>(storeDir, config.diskBytes);
+        if (! disk->isValid())
+            disk.reset();
+    }
+}
+
+CachingTts::~CachingTts() = default;
+
+juce::File CachingTts::defaultStoreDir()
+{
+    return juce::File::getSpecialLocation(juce::File::userApplicationDataDirectory)
+        .getChildFile("LiveTranslator").getChildFile("tts");
+}
+
+void CachingTts::synthesize(const TtsRequest& req,
+                            std::function<void(const std::vector<float>&, bool)> onChunk)
+{
+    if (req.text.empty() || req.text.size() > config.maxTextChars)
+    {
+        inner.synthesize(req, std::move(onChunk));
+        return;
+    }
+
+    const std::string key = req.text + '\x1f' + req.voice + '\x1f' + req.style + '\x1f' + req.format;
+
+    PcmPtr cached;
+    {
+        std::lock_guard<std::mutex> lg(mx);
+        cached = findInMemory(key);
+    }
+    if (cached != nullptr)
+    {
+        ++hits;
+        if (disk)
+            disk->touch(key);
+        play(cached->data(), cached->size(), onChunk);
+        return;
+    }
+
+    DiskStore::Mapped mapped;
+    if (disk && disk->open(key, mapped))
+    {
+        ++hits;
+        ++diskHits;
+        // straight from the mapping; the copy kept in memory is made after
+        // the audio has been handed on
+        play(mapped.samples, mapped.numSamples, onChunk);
+        auto pcm = std::make_shared<const Pcm>(mapped.samples, mapped.samples + mapped.numSamples);
+        std::lock_guard<std::mutex> lg(mx);
+        remember(key, std::move(pcm));
+        return;
+    }
+
+    ++misses;
+    Pcm pcm;
+    bool complete = false;
+    inner.synthesize(req, [&](const std::vector<float>& chunk, bool eof) {
+        for (float x : chunk)
+            pcm.push_back((int16_t) juce::jlimit(-32768, 32767, (int) std::lrint(x * 32768.0f)));
+        if (eof)
+            complete = ! chunk.empty();
+        onChunk(chunk, eof);
+    });
+
+    // an empty eof means the backend failed or stopped early
+    if (! complete || pcm.empty())
+        return;
+
+    auto shared = std::make_shared<const Pcm>(std::move(pcm));
+    if (disk)
+        disk->store(key, *shared);
+    std::lock_guard<std::mutex> lg(mx);
+    remember(key, std::move(shared));
+}
+
+CachingTts::Stats CachingTts::getStats() const
+{
+    Stats s;
+    s.hits = hits.load();
+    s.diskHits = diskHits.load();
+    s.misses = misses.load();
+    {
+        std::lock_guard<std::mutex> lg(mx);
+        s.memoryBytes = memoryUsed;
+    }
+    s.diskBytes = disk ? disk->bytesUsed() : 0;
+    return s;
+}
+
+CachingTts::PcmPtr CachingTts::findInMemory(const std::string& key)
+{
+    auto it = index.find(key);
+    if (it == index.end())
+        return nullptr;
+
+    lru.splice(lru.begin(), lru, it->second);
+    return it->second->second;
+}
+
+void CachingTts::remember(const std::string& key, PcmPtr pcm)
+{
+    const size_t bytes = pcm->size() * sizeof(int16_t);
+    if (bytes > config.memoryBytes)
+        return; // would push out everything else; the disk copy will do
+
+    auto it = index.find(key);
+    if (it != index.end())
+    {
+        memoryUsed -= it->second->second->size() * sizeof(int16_t);
+        lru.erase(it->second);
+        index.erase(it);
+    }
+
+    lru.emplace_front(key, std::move(pcm));
+    index[key] = lru.begin();
+    memoryUsed += bytes;
+
+    while (memoryUsed > config.memoryBytes)
+    {
+        memoryUsed -= lru.back().second->size() * sizeof(int16_t);
+        index.erase(lru.back().first);
+        lru.pop_back();
+    }
+}
+
+void CachingTts::play(const int16_t* samples, size_t numSamples,
+                      const std::function<void(const std::vector<float>&, bool)>& onChunk) const
+{
+    const size_t step = std::max<size_t>(1, config.chunkSamples);
+    std::vector<float> chunk;
+    chunk.reserve(step);
+
+    for (size_t pos = 0; pos < numSamples;)
+    {
+        const size_t count = std::min(step, numSamples - pos);
+        chunk.resize(count);
+        for (size_t i = 0; i < count; ++i)
+            chunk[i] = (float) samples[pos + i] * (1.0f / 32768.0f);
+        pos += count;
+        onChunk(chunk, pos == numSamples);
+    }
+}
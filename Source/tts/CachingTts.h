@@ -0,0 +1,76 @@
+#pragma once
+#include <atomic>
+#include <cstdint>
+#include <list>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <unordered_map>
+#include <vector>
+#include <juce_core/juce_core.h>
+#include "ITts.h"
+
+// Caching decorator for any ITts. Synthesized speech is keyed by text,
+// voice, style and output format and kept as 16-bit PCM: hot entries in an
+// in-memory LRU, the rest spilled to one small file per entry in storeDir,
+// memory-mapped on read. Both tiers evict least-recently-used entries by
+// byte budget. A hit is handed to onChunk in full before synthesize()
+// returns, so it is queued for playback without a network round trip. Only
+// complete syntheses (eof on a non-empty chunk) are stored, so a cut-off
+// result, or ResilientTts' fallback (which ends on an empty eof), is never
+// replayed. Wrap it around ResilientTts rather than inside it, so hits stay
+// out of the backend's latency and breaker accounting.
+class CachingTts : public ITts
+{
+public:
+    struct Config
+    {
+        size_t memoryBytes = 8 * 1024 * 1024;   // ~4 min of 16 kHz speech
+        uint64_t diskBytes = 64 * 1024 * 1024;
+        size_t chunkSamples = 1600;             // per onChunk call on a hit
+        size_t maxTextChars = 200;              // longer text rarely repeats
+    };
+
+    struct Stats
+    {
+        uint64_t hits = 0;       // memory or disk
+        uint64_t diskHits = 0;
+        uint64_t misses = 0;     // went to the wrapped backend
+        uint64_t memoryBytes = 0, diskBytes = 0;
+    };
+
+    // storeDir: where spilled entries live; an invalid File keeps it memory-only
+    CachingTts(ITts& inner, const juce::File& storeDir, const Config& config);
+    CachingTts(ITts& inner, const juce::File& storeDir) : CachingTts(inner, storeDir, Config {}) {}
+    ~CachingTts() override;
+
+    void synthesize(const TtsRequest& req,
+                    std::function<void(const std::vector<float>&, bool)> onChunk) override;
+
+    Stats getStats() const;
+
+    static juce::File defaultStoreDir();
+
+private:
+    using Pcm = std::vector<int16_t>;
+    using PcmPtr = std::shared_ptr<const Pcm>;
+
+    class DiskStore;
+
+    PcmPtr findInMemory(const std::string& key); // mx held
+    void remember(const std::string& key, PcmPtr pcm); // mx held
+    void play(const int16_t* samples, size_t numSamples,
+              const std::function<void(const std::vector<float>&, bool)>& onChunk) const;
+
+    ITts& inner;
+    const Config config;
+
+    mutable std::mutex mx;
+    using Entry = std::pair<std::string, PcmPtr>;   // key, samples
+    std::list<Entry> lru;                           // most recent first
+    std::unordered_map<std::string, std::list<Entry>::iterator> index;
+    size_t memoryUsed = 0;
+    std::unique_ptr<DiskStore> disk;
+
+    std::atomic<uint64_t> hits { 0 }, diskHits { 0 }, misses { 0 };
+};
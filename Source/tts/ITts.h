@@ -1,16 +1,22 @@
 #pragma once
+#include <functional>
 #include <string>
 #include <vector>
 
 struct TtsRequest {
     std::string text;
-    // language, voice, style, etc. can be added
+    int budgetMs = 0;    // time-to-first-audio budget, 0 = backend default
+    std::string voice;   // backend voice name, "" = backend default
+    std::string style;   // speaking style, "" = neutral
+    std::string format = "riff-16000hz-16bit-mono-pcm"; // wire format asked of the service
 };
 
 class ITts {
 public:
     virtual ~ITts() = default;
     // Generate 16kHz mono PCM in chunks; may be called on a worker thread.
+    // A complete synthesis ends with eof on a chunk carrying its last
+    // samples; an empty eof chunk means the backend failed or stopped early.
     virtual void synthesize(const TtsRequest& req,
                             std::function<void(const std::vector<float>&, bool eof)> onChunk) = 0;
 };
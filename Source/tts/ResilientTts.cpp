@@ -0,0 +1,168 @@
+#include "ResilientTts.h"
+#include <condition_variable>
+#include <mutex>
+#include <utility>
+
+struct ResilientTts::Call
+{
+    TtsRequest request;
+    std::function<void(const std::vector<float>&, bool)> onChunk;
+
+    std::mutex mx;
+    std::condition_variable cv;
+    int running = 0;
+    int winner = -1;      // attempt streaming to the caller; abandoned once it's -2
+    bool finished = false; // winner delivered eof
+    bool complete = false; // ... on a chunk with audio in it, rather than cut off
+};
+
+ResilientTts::ResilientTts(ITts& p, ITts& f, const Config& c)
+: primary(p), fallback(f), config(c), breaker(c.failureThreshold, c.coolDownMs)
+{
+}
+
+ResilientTts::~ResilientTts()
+{
+    pool.removeAllJobs(true, 15000);
+}
+
+void ResilientTts::launch(const std::shared_ptr<Call>& call, int attempt)
+{
+    {
+        std::lock_guard<std::mutex> lg(call->mx);
+        ++call->running;
+    }
+
+    pool.addJob([this, call, attempt]
+    {
+        const double t0 = juce::Time::getMillisecondCounterHiRes();
+        bool first = true;
+
+        primary.synthesize(call->request, [&](const std::vector<float>& pcm, bool eof)
+        {
+            if (first && ! pcm.empty())
+                latency.add(juce::Time::getMillisecondCounterHiRes() - t0);
+
+            std::lock_guard<std::mutex> lg(call->mx);
+            const bool wasFirst = std::exchange(first, false);
+
+            // the first attempt with real audio takes the stream
+            if (call->winner == -1 && wasFirst && ! pcm.empty())
+                call->winner = attempt;
+            if (call->winner != attempt)
+                return;
+
+            call->onChunk(pcm, eof);
+            if (eof)
+            {
+                call->finished = true;
+                call->complete = ! pcm.empty();
+                call->cv.notify_all();
+            }
+        });
+
+        std::lock_guard<std::mutex> lg(call->mx);
+        --call->running;
+        if (call->winner == attempt && ! call->finished)
+        {
+            call->onChunk({}, true); // backend ended without an eof chunk
+            call->finished = true;
+        }
+        call->cv.notify_all();
+    });
+}
+
+// the fallback's audio as-is, then an empty eof: to the caller it is still a
+// failed synthesis
+void ResilientTts::speakFallback(const TtsRequest& req,
+                                 const std::function<void(const std::vector<float>&, bool)>& onChunk)
+{
+    fallback.synthesize(req, [&onChunk](const std::vector<float>& pcm, bool)
+    {
+        if (! pcm.empty())
+            onChunk(pcm, false);
+    });
+    onChunk({}, true);
+}
+
+void ResilientTts::synthesize(const TtsRequest& req,
+                              std::function<void(const std::vector<float>&, bool)> onChunk)
+{
+    ++calls;
+    if (req.text.empty())
+    {
+        onChunk({}, true);
+        return;
+    }
+
+    if (! breaker.allow())
+    {
+        ++fallbacks;
+        speakFallback(req, onChunk);
+        return;
+    }
+
+    const int budget = req.budgetMs > 0 ? req.budgetMs : config.budgetMs;
+
+    auto call = std::make_shared<Call>();
+    call->request = req;
+    call->request.budgetMs = budget;
+    call->onChunk = onChunk;
+
+    using namespace std::chrono;
+    const auto deadline = steady_clock::now() + milliseconds(budget);
+    const auto settled = [&call] { return call->winner >= 0 || call->running == 0; };
+
+    launch(call, 0);
+
+    std::unique_lock<std::mutex> lk(call->mx);
+
+    const double p95 = latency.p95();
+    if (config.hedge && p95 > 0.0 && p95 < budget)
+    {
+        if (! call->cv.wait_until(lk, steady_clock::now() + milliseconds((int) p95), settled))
+        {
+            ++hedges;
+            lk.unlock();
+            launch(call, 1);
+            lk.lock();
+        }
+    }
+
+    if (call->cv.wait_until(lk, deadline, settled) && call->winner >= 0)
+    {
+        if (call->winner == 1) ++hedgeWins;
+
+        // audio is flowing: let it play out. A stream that broke off (empty
+        // final chunk) still counts against the backend.
+        call->cv.wait(lk, [&call] { return call->finished; });
+        const bool complete = call->complete;
+        lk.unlock();
+        if (complete)
+            breaker.onSuccess();
+        else
+            breaker.onFailure();
+        return;
+    }
+
+    if (call->running > 0) ++timeouts;
+    call->winner = -2;
+    lk.unlock();
+
+    breaker.onFailure();
+    ++fallbacks;
+    speakFallback(req, onChunk);
+}
+
+ResilientTts::Stats ResilientTts::getStats() const
+{
+    Stats s;
+    s.calls = calls.load();
+    s.fallbacks = fallbacks.load();
+    s.timeouts = timeouts.load();
+    s.hedges = hedges.load();
+    s.hedgeWins = hedgeWins.load();
+    s.breakerTrips = breaker.getTrips();
+    s.p95Ms = latency.p95();
+    return s;
+}
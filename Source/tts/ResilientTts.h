@@ -0,0 +1,60 @@
+#pragma once
+#include <atomic>
+#include <memory>
+#include <juce_core/juce_core.h>
+#include "ITts.h"
+#include "../net/CircuitBreaker.h"
+#include "../net/LatencyTracker.h"
+
+// Deadline, circuit breaker and optional hedging for a network TTS backend.
+// The budget is time-to-first-audio: if no PCM has arrived by then (or the
+// breaker is open) the fallback (e.g. BeepTts) speaks instead and anything
+// the late request produces is dropped. Once a request has started
+// delivering audio it is streamed to the end. With hedging on, a second
+// request goes out when the first is slower than the recent p95, and the
+// first one to deliver audio wins. An empty final chunk counts as a failure.
+// Fallback audio is followed by an empty eof chunk of its own, so a cache
+// around this class (CachingTts) never stores it.
+class ResilientTts : public ITts
+{
+public:
+    struct Config
+    {
+        int budgetMs = 2500;
+        bool hedge = true;
+        int failureThreshold = 3;
+        double coolDownMs = 15000.0;
+    };
+
+    struct Stats
+    {
+        uint64_t calls = 0, fallbacks = 0, timeouts = 0, hedges = 0, hedgeWins = 0;
+        int breakerTrips = 0;
+        double p95Ms = -1.0;     // time to first audio
+    };
+
+    ResilientTts(ITts& primary, ITts& fallback, const Config& config);
+    ResilientTts(ITts& primary, ITts& fallback) : ResilientTts(primary, fallback, Config {}) {}
+    ~ResilientTts() override;
+
+    void synthesize(const TtsRequest& req,
+                    std::function<void(const std::vector<float>&, bool)> onChunk) override;
+
+    Stats getStats() const;
+
+private:
+    struct Call;
+    void launch(const std::shared_ptr<Call>& call, int attempt);
+    void speakFallback(const TtsRequest& req,
+                       const std::function<void(const std::vector<float>&, bool)>& onChunk);
+
+    ITts& primary;
+    ITts& fallback;
+    const Config config;
+
+    CircuitBreaker breaker;
+    LatencyTracker latency;
+    juce::ThreadPool pool { 4 };
+
+    std::atomic<uint64_t> calls { 0 }, fallbacks { 0 }, timeouts { 0 }, hedges { 0 }, hedgeWins { 0 };
+};
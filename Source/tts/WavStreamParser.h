@@ -0,0 +1,205 @@
+#pragma once
+#include <algorithm>
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+#include <vector>
+
+// Incremental RIFF/WAVE reader for 16 kHz 16-bit PCM that arrives in
+// arbitrary pieces (an HTTP body as it downloads). The header is parsed
+// once; after that samples are converted from the raw bytes straight into
+// fixed-size float chunks, each handed on as soon as it fills, so playback
+// can start with the first chunk instead of after the whole download.
+// Multi-channel input is downmixed. A data chunk size of 0 or 0xffffffff
+// (what streaming encoders write before they know the length) means "until
+// the stream ends". A full chunk goes out when the first sample after it
+// arrives, so the last one is always left for takeRemainder() and a
+// complete stream never ends on an empty eof chunk. complete() tells a
+// bounded stream that was cut short from one that ended properly.
+class WavStreamParser
+{
+public:
+    using OnPcm = std::function<void (const std::vector<float>& pcm)>;
+
+    WavStreamParser(size_t samplesPerChunk, OnPcm onPcm)
+        : chunkSamples(samplesPerChunk > 0 ? samplesPerChunk : 1), emit(std::move(onPcm))
+    {
+        chunk.reserve(chunkSamples);
+    }
+
+    // False once the stream turned out not to be 16 kHz 16-bit PCM (the
+    // caller can abort the download); everything after that is ignored
+    bool feed(const void* data, size_t size)
+    {
+        const auto* bytes = static_cast<const uint8_t*>(data);
+
+        if (stage == Stage::header)
+        {
+            header.insert(header.end(), bytes, bytes + size);
+            if (! parseHeader())
+                return stage != Stage::failed;
+
+            // whatever followed the data chunk header is already audio
+            std::vector<uint8_t> rest(header.begin() + (std::ptrdiff_t) headerPos, header.end());
+            header.clear();
+            header.shrink_to_fit();
+            consume(rest.data(), rest.size());
+            return true;
+        }
+
+        if (stage == Stage::data)
+            consume(bytes, size);
+        return stage != Stage::failed;
+    }
+
+    // The last chunk (full or partial), for the caller's eof callback
+    std::vector<float> takeRemainder()
+    {
+        std::vector<float> tail;
+        tail.swap(chunk);
+        return tail;
+    }
+
+    bool failed() const      { return stage == Stage::failed; }
+    // The whole data chunk arrived: a bounded one down to its last byte, an
+    // unbounded one whenever the stream ends (nothing to compare against)
+    bool complete() const    { return stage == Stage::data && (! bounded || dataRemaining == 0); }
+    bool inData() const      { return stage == Stage::data; }
+    uint64_t samplesOut() const { return produced; }
+
+    static constexpr int sampleRate = 16000;
+
+private:
+    enum class Stage { header, data, failed };
+
+    static uint32_t le32(const uint8_t* p) { return (uint32_t) p[0] | ((uint32_t) p[1] << 8) | ((uint32_t) p[2] << 16) | ((uint32_t) p[3] << 24); }
+    static uint16_t le16(const uint8_t* p) { return (uint16_t) (p[0] | (p[1] << 8)); }
+    static bool is(const uint8_t* p, const char* id) { return p[0] == id[0] && p[1] == id[1] && p[2] == id[2] && p[3] == id[3]; }
+
+    // True once the data chunk starts (headerPos = its first byte); false
+    // while more bytes are needed or after a failure
+    bool parseHeader()
+    {
+        static constexpr size_t maxHeader = 64 * 1024; // a sane LIST / metadata allowance
+
+        if (header.size() < 12)
+            return false;
+        if (! is(&header[0], "RIFF") || ! is(&header[8], "WAVE"))
+            return fail();
+
+        if (headerPos < 12)
+            headerPos = 12;
+
+        while (header.size() >= headerPos + 8)
+        {
+            const uint8_t* c = &header[headerPos];
+            const uint32_t size = le32(c + 4);
+
+            if (is(c, "data"))
+            {
+                if (channels == 0)
+                    return fail(); // no fmt chunk before the audio
+
+                bounded = size != 0 && size != 0xffffffffu;
+                dataRemaining = size;
+                headerPos += 8;
+                stage = Stage::data;
+                return true;
+            }
+
+            const size_t next = headerPos + 8 + size + (size & 1u); // chunks are word aligned
+            if (next > maxHeader)
+                return fail();
+            if (header.size() < next)
+                return false;
+
+            if (is(c, "fmt "))
+            {
+                if (size < 16)
+                    return fail();
+                const uint16_t format = le16(c + 8);
+                channels = le16(c + 10);
+                const uint32_t rate = le32(c + 12);
+                const uint16_t bits = le16(c + 22);
+
+                // 1 = PCM, 0xfffe = WAVE_FORMAT_EXTENSIBLE (PCM sub-format in practice)
+                if ((format != 1 && format != 0xfffe) || bits != 16 || rate != (uint32_t) sampleRate
+                    || channels == 0 || channels > maxChannels)
+                    return fail();
+            }
+            headerPos = next;
+        }
+        return false;
+    }
+
+    bool fail()
+    {
+        stage = Stage::failed;
+        return false;
+    }
+
+    void consume(const uint8_t* bytes, size_t size)
+    {
+        if (bounded)
+        {
+            size = (size_t) std::min<uint64_t>(size, dataRemaining);
+            dataRemaining -= size;
+        }
+
+        const size_t frameBytes = 2u * channels;
+        const float scale = 1.0f / (32768.0f * (float) channels);
+
+        // a frame split across two pieces of the body
+        if (carried > 0)
+        {
+            const size_t take = std::min(frameBytes - carried, size);
+            for (size_t i = 0; i < take; ++i)
+                carry[carried++] = bytes[i];
+            bytes += take;
+            size -= take;
+            if (carried < frameBytes)
+                return;
+            push(carry, scale);
+            carried = 0;
+        }
+
+        for (; size >= frameBytes; bytes += frameBytes, size -= frameBytes)
+            push(bytes, scale);
+
+        for (size_t i = 0; i < size; ++i)
+            carry[carried++] = bytes[i];
+    }
+
+    void push(const uint8_t* frame, float scale)
+    {
+        if (chunk.size() == chunkSamples)
+        {
+            emit(chunk);
+            chunk.clear(); // keeps its capacity
+        }
+
+        int sum = 0;
+        for (uint16_t ch = 0; ch < channels; ++ch)
+            sum += (int16_t) le16(frame + 2 * ch);
+        chunk.push_back((float) sum * scale);
+        ++produced;
+    }
+
+    const size_t chunkSamples;
+    OnPcm emit;
+
+    Stage stage = Stage::header;
+    std::vector<uint8_t> header;  // until the data chunk starts
+    size_t headerPos = 0;
+
+    uint16_t channels = 0;
+    bool bounded = false;
+    uint64_t dataRemaining = 0;
+
+    static constexpr uint16_t maxChannels = 8;
+    uint8_t carry[2 * maxChannels] {}; // partial frame
+    size_t carried = 0;
+
+    std::vector<float> chunk;
+    uint64_t produced = 0;
+};
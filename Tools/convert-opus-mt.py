@@ -0,0 +1,283 @@
+#!/usr/bin/env python3
+"""Converts a Hugging Face MarianMT checkpoint (Helsinki-NLP/opus-mt-*) to the
+GGUF layout MarianModel loads (see Source/translate/MarianModel.h).
+
+    convert-opus-mt.py <checkpoint dir> <out.gguf> [--type f32|f16|q8_0]
+                       [--reference refs.tsv --sentences in.txt]
+
+The checkpoint directory is what `git clone https://huggingface.co/Helsinki-NLP/opus-mt-en-de`
+gives you: config.json, vocab.json, source.spm and model.safetensors
+(pytorch_model.bin works too when torch is installed). Name the output
+opus-mt-<src>-<dst>.gguf and drop it into LocalTranslator::defaultModelDir().
+
+--reference writes the transformers model's own greedy translations of
+in.txt (one sentence per line) as "source<TAB>reference" lines; MarianBench
+--check compares the converted model against them. Needs torch and
+transformers.
+
+Needs numpy, safetensors and sentencepiece; the GGUF writer is our own, so
+the gguf package isn't required.
+"""
+import argparse
+import json
+import os
+import struct
+import sys
+
+import numpy as np
+import sentencepiece as spm
+
+GGUF_VERSION = 3
+ALIGNMENT = 32
+
+# gguf value types
+T_UINT32, T_INT32, T_FLOAT32, T_BOOL, T_STRING, T_ARRAY = 4, 5, 6, 7, 8, 9
+
+# ggml tensor types
+GGML_F32, GGML_F16, GGML_Q8_0 = 0, 1, 8
+QK8_0 = 32
+
+
+class GgufWriter:
+    def __init__(self):
+        self.kv = []        # (key, type, value)
+        self.tensors = []   # (name, ggml type, shape in ggml order, bytes)
+
+    def add_u32(self, key, v):    self.kv.append((key, T_UINT32, int(v)))
+    def add_i32(self, key, v):    self.kv.append((key, T_INT32, int(v)))
+    def add_bool(self, key, v):   self.kv.append((key, T_BOOL, bool(v)))
+    def add_string(self, key, v): self.kv.append((key, T_STRING, str(v)))
+    def add_strings(self, key, v): self.kv.append((key, T_ARRAY, (T_STRING, list(v))))
+    def add_floats(self, key, v):  self.kv.append((key, T_ARRAY, (T_FLOAT32, [float(x) for x in v])))
+
+    def add_tensor(self, name, array, ggml_type):
+        # numpy is row-major, so a [rows, cols] array is ggml's [cols, rows]
+        shape = list(reversed(array.shape))
+        if ggml_type == GGML_F32:
+            data = np.ascontiguousarray(array, dtype=np.float32).tobytes()
+        elif ggml_type == GGML_F16:
+            data = np.ascontiguousarray(array, dtype=np.float16).tobytes()
+        elif ggml_type == GGML_Q8_0:
+            data = quantize_q8_0(array)
+        else:
+            raise ValueError(ggml_type)
+        self.tensors.append((name, ggml_type, shape, data))
+
+    def write(self, path):
+        out = bytearray()
+        out += b"GGUF" + struct.pack("<IQQ", GGUF_VERSION, len(self.tensors), len(self.kv))
+        for key, vtype, value in self.kv:
+            out += pack_string(key) + struct.pack("<I", vtype) + pack_value(vtype, value)
+
+        offset = 0
+        for name, ggml_type, shape, data in self.tensors:
+            out += pack_string(name) + struct.pack("<I", len(shape))
+            out += b"".join(struct.pack("<Q", n) for n in shape)
+            out += struct.pack("<IQ", ggml_type, offset)
+            offset += padded(len(data))
+
+        out += b"\0" * (padded(len(out)) - len(out))
+        tmp = path + ".tmp"
+        with open(tmp, "wb") as f:
+            f.write(out)
+            for _, _, _, data in self.tensors:
+                f.write(data)
+                f.write(b"\0" * (padded(len(data)) - len(data)))
+        os.replace(tmp, path)
+
+
+def padded(n):
+    return (n + ALIGNMENT - 1) // ALIGNMENT * ALIGNMENT
+
+
+def pack_string(s):
+    b = s.encode("utf-8")
+    return struct.pack("<Q", len(b)) + b
+
+
+def pack_value(vtype, v):
+    if vtype == T_UINT32: return struct.pack("<I", v)
+    if vtype == T_INT32:  return struct.pack("<i", v)
+    if vtype == T_FLOAT32: return struct.pack("<f", v)
+    if vtype == T_BOOL:   return struct.pack("<B", 1 if v else 0)
+    if vtype == T_STRING: return pack_string(v)
+    if vtype == T_ARRAY:
+        itype, items = v
+        return struct.pack("<IQ", itype, len(items)) + b"".join(pack_value(itype, x) for x in items)
+    raise ValueError(vtype)
+
+
+def quantize_q8_0(array):
+    """ggml's block_q8_0: per 32 values an fp16 scale and 32 int8s."""
+    x = np.ascontiguousarray(array, dtype=np.float32).reshape(-1, QK8_0)
+    amax = np.abs(x).max(axis=1, keepdims=True)
+    d = amax / 127.0
+    inv = np.divide(1.0, d, out=np.zeros_like(d), where=d != 0)
+    q = np.round(x * inv).astype(np.int8)
+    blocks = np.empty(x.shape[0], dtype=[("d", "<f2"), ("qs", "i1", QK8_0)])
+    blocks["d"] = d[:, 0].astype(np.float16)
+    blocks["qs"] = q
+    return blocks.tobytes()
+
+
+def load_weights(ckpt):
+    path = os.path.join(ckpt, "model.safetensors")
+    if os.path.exists(path):
+        from safetensors.numpy import load_file
+        return load_file(path)
+
+    path = os.path.join(ckpt, "pytorch_model.bin")
+    if os.path.exists(path):
+        import torch
+        state = torch.load(path, map_location="cpu", weights_only=True)
+        return {k: v.float().numpy() for k, v in state.items()}
+
+    sys.exit(f"no model.safetensors or pytorch_model.bin in {ckpt}")
+
+
+def load_vocab(ckpt, unk_piece):
+    """Pieces in Marian id order, with the source model's log-probabilities.
+    Pieces only the target side knows get a score below any real one, so the
+    encoder never prefers them; decoding doesn't use scores."""
+    with open(os.path.join(ckpt, "vocab.json"), encoding="utf-8") as f:
+        vocab = json.load(f)
+    pieces = [None] * (max(vocab.values()) + 1)
+    for piece, i in vocab.items():
+        pieces[i] = piece
+    pieces = [p if p is not None else unk_piece for p in pieces]
+
+    sp = spm.SentencePieceProcessor(model_file=os.path.join(ckpt, "source.spm"))
+    source = {sp.id_to_piece(i): sp.get_score(i) for i in range(sp.get_piece_size())}
+    floor = min(source.values()) - 10.0
+    scores = [source.get(p, floor) for p in pieces]
+    return pieces, scores
+
+
+def tensor_type(name, array, wanted):
+    # norms, biases and anything that doesn't fill whole q8_0 blocks stay f32
+    if array.ndim < 2 or wanted == GGML_F32:
+        return GGML_F32
+    if wanted == GGML_Q8_0 and array.shape[-1] % QK8_0 != 0:
+        return GGML_F16
+    return wanted
+
+
+def convert(ckpt, out_path, wanted_type):
+    with open(os.path.join(ckpt, "config.json"), encoding="utf-8") as f:
+        cfg = json.load(f)
+    if cfg.get("model_type") != "marian":
+        sys.exit(f"{ckpt} is a {cfg.get('model_type')!r} checkpoint; this converter handles MarianMT (opus-mt)")
+
+    w = load_weights(ckpt)
+    prefix = "model." if "model.shared.weight" in w or "model.encoder.embed_tokens.weight" in w else ""
+    pieces, scores = load_vocab(ckpt, "<unk>")
+    vocab = {p: i for i, p in enumerate(pieces)}
+
+    g = GgufWriter()
+    g.add_string("general.architecture", "marian")
+    g.add_string("general.name", os.path.basename(os.path.normpath(ckpt)))
+    g.add_u32("marian.d_model", cfg["d_model"])
+    g.add_u32("marian.n_heads", cfg["encoder_attention_heads"])
+    g.add_u32("marian.encoder_layers", cfg["encoder_layers"])
+    g.add_u32("marian.decoder_layers", cfg["decoder_layers"])
+    g.add_u32("marian.ffn_dim", cfg["encoder_ffn_dim"])
+    g.add_u32("marian.max_len", cfg.get("max_position_embeddings", 512))
+    g.add_u32("marian.pos_offset", 0)
+    g.add_bool("marian.pre_norm", cfg.get("normalize_before", False))
+    g.add_bool("marian.scale_embedding", cfg.get("scale_embedding", True))
+    g.add_string("marian.activation", {"silu": "swish"}.get(cfg.get("activation_function", "swish"),
+                                                            cfg.get("activation_function", "swish")))
+
+    g.add_strings("tokenizer.ggml.tokens", pieces)
+    g.add_floats("tokenizer.ggml.scores", scores)
+    g.add_i32("tokenizer.eos_id", cfg.get("eos_token_id", vocab.get("</s>", 0)))
+    g.add_i32("tokenizer.pad_id", cfg.get("pad_token_id", vocab.get("<pad>", 0)))
+    g.add_i32("tokenizer.unk_id", vocab.get("<unk>", 1))
+    g.add_i32("tokenizer.decoder_start_id", cfg.get("decoder_start_token_id", cfg.get("pad_token_id", 0)))
+    g.add_i32("tokenizer.src_prefix_id", -1)
+    g.add_i32("tokenizer.forced_bos_id", -1)
+
+    def add(name, array):
+        g.add_tensor(name, array, tensor_type(name, array, wanted_type))
+
+    shared = w.get(prefix + "shared.weight", w.get(prefix + "encoder.embed_tokens.weight"))
+    if shared.shape[0] != len(pieces):
+        sys.exit(f"embedding has {shared.shape[0]} rows but vocab.json {len(pieces)} pieces")
+    add("embed_tokens.weight", shared)
+    if "final_logits_bias" in w:
+        g.add_tensor("final_logits_bias", w["final_logits_bias"].reshape(-1), GGML_F32)
+    if "lm_head.weight" in w and not np.array_equal(w["lm_head.weight"], shared):
+        add("lm_head.weight", w["lm_head.weight"])
+
+    def linear(dst, src):
+        add(dst + ".w", w[src + ".weight"])
+        g.add_tensor(dst + ".b", w[src + ".bias"], GGML_F32)
+
+    def norm(dst, src):
+        g.add_tensor(dst + ".w", w[src + ".weight"], GGML_F32)
+        g.add_tensor(dst + ".b", w[src + ".bias"], GGML_F32)
+
+    def attention(dst, src):
+        for ours, theirs in (("q", "q_proj"), ("k", "k_proj"), ("v", "v_proj"), ("o", "out_proj")):
+            linear(f"{dst}.{ours}", f"{src}.{theirs}")
+
+    for i in range(cfg["encoder_layers"]):
+        src, dst = f"{prefix}encoder.layers.{i}", f"enc.{i}"
+        attention(dst + ".attn", src + ".self_attn")
+        norm(dst + ".attn_ln", src + ".self_attn_layer_norm")
+        linear(dst + ".fc1", src + ".fc1")
+        linear(dst + ".fc2", src + ".fc2")
+        norm(dst + ".ffn_ln", src + ".final_layer_norm")
+
+    for i in range(cfg["decoder_layers"]):
+        src, dst = f"{prefix}decoder.layers.{i}", f"dec.{i}"
+        attention(dst + ".attn", src + ".self_attn")
+        norm(dst + ".attn_ln", src + ".self_attn_layer_norm")
+        attention(dst + ".cross", src + ".encoder_attn")
+        norm(dst + ".cross_ln", src + ".encoder_attn_layer_norm")
+        linear(dst + ".fc1", src + ".fc1")
+        linear(dst + ".fc2", src + ".fc2")
+        norm(dst + ".ffn_ln", src + ".final_layer_norm")
+
+    for side in ("encoder", "decoder"):
+        if prefix + side + ".layer_norm.weight" in w:
+            norm(side[:3] + ".ln", prefix + side + ".layer_norm")
+
+    g.write(out_path)
+    size = os.path.getsize(out_path)
+    print(f"{out_path}: {len(g.tensors)} tensors, {len(pieces)} pieces, {size / 1e6:.1f} MB")
+
+
+def write_reference(ckpt, sentences_path, out_path):
+    from transformers import MarianMTModel, MarianTokenizer
+    tok = MarianTokenizer.from_pretrained(ckpt)
+    model = MarianMTModel.from_pretrained(ckpt).eval()
+    with open(sentences_path, encoding="utf-8") as f:
+        sentences = [line.strip() for line in f if line.strip()]
+
+    with open(out_path, "w", encoding="utf-8") as out:
+        for s in sentences:
+            batch = tok([s], return_tensors="pt")
+            ids = model.generate(**batch, num_beams=1, do_sample=False, max_new_tokens=256)
+            out.write(s + "\t" + tok.decode(ids[0], skip_special_tokens=True) + "\n")
+    print(f"{out_path}: {len(sentences)} reference translations")
+
+
+def main():
+    ap = argparse.ArgumentParser(description=__doc__, formatter_class=argparse.RawDescriptionHelpFormatter)
+    ap.add_argument("checkpoint")
+    ap.add_argument("output")
+    ap.add_argument("--type", choices=("f32", "f16", "q8_0"), default="q8_0")
+    ap.add_argument("--reference", help="also write transformers' greedy output for --sentences here")
+    ap.add_argument("--sentences", help="one source sentence per line, for --reference")
+    args = ap.parse_args()
+
+    convert(args.checkpoint, args.output, {"f32": GGML_F32, "f16": GGML_F16, "q8_0": GGML_Q8_0}[args.type])
+    if args.reference:
+        if not args.sentences:
+            sys.exit("--reference needs --sentences")
+        write_reference(args.checkpoint, args.sentences, args.reference)
+
+
+if __name__ == "__main__":
+    main()